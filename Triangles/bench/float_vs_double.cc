@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "triangle_soa.hh"
+
+// Runs the same random triangle soup through the float and double pipelines and reports
+// their speed and how often the float results disagree with the double ones. The pipelines are also checked
+// against their own exact test, which must agree whatever the precision.
+
+namespace
+{
+
+using geometry3D::Triangle3D;
+using geometry3D::TriangleSoA;
+
+template <typename T>
+Triangle3D<T> convert(const Triangle3D<double>& tr)
+{
+    auto point = [&](int vertex)
+    {
+        return geometry3D::Point3D<T>{static_cast<T>(tr[vertex].coords[0]),
+                                      static_cast<T>(tr[vertex].coords[1]),
+                                      static_cast<T>(tr[vertex].coords[2])};
+    };
+
+    return Triangle3D<T>{point(0), point(1), point(2)};
+}
+
+template <typename T>
+double measure(const TriangleSoA<T>& soa, std::vector<std::size_t>& result)
+{
+    auto start = std::chrono::steady_clock::now();
+    result = geometry3D::intersectingTriangles(soa);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    double size = (argc > 2) ? std::strtod(argv[2], nullptr) : 1.0;
+    double origin = (argc > 3) ? std::strtod(argv[3], nullptr) : 0.0;
+
+    std::mt19937 gen{2022};
+    std::uniform_real_distribution<double> position{origin, origin + 100};
+    std::uniform_real_distribution<double> offset{-size, size};
+
+    std::vector<Triangle3D<double>> soup;
+    TriangleSoA<double> doubleSoA;
+    TriangleSoA<float> floatSoA;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        double x = position(gen), y = position(gen), z = position(gen);
+        soup.push_back(Triangle3D<double>{{x + offset(gen), y + offset(gen), z + offset(gen)},
+                                          {x + offset(gen), y + offset(gen), z + offset(gen)},
+                                          {x + offset(gen), y + offset(gen), z + offset(gen)}});
+
+        doubleSoA.push_back(soup.back());
+        floatSoA.push_back(convert<float>(soup.back()));
+    }
+
+    std::vector<std::size_t> doubleResult, floatResult;
+
+    double doubleTime = measure(doubleSoA, doubleResult);
+    double floatTime = measure(floatSoA, floatResult);
+
+    std::size_t pairs = 0, mismatchedPairs = 0;
+    std::vector<bool> exactDouble(count), exactFloat(count);
+    for (std::size_t first = 0; first < count; ++first)
+        for (std::size_t second = first + 1; second < count; ++second)
+        {
+            bool exact = triangleTriangleIntersect(soup[first], soup[second]);
+            bool approx = triangleTriangleIntersect(floatSoA[first], floatSoA[second]);
+
+            pairs += exact;
+            mismatchedPairs += (exact != approx);
+
+            if (exact)
+                exactDouble[first] = exactDouble[second] = true;
+            if (approx)
+                exactFloat[first] = exactFloat[second] = true;
+        }
+
+    std::vector<bool> inDouble(count), inFloat(count);
+    for (auto idx : doubleResult)
+        inDouble[idx] = true;
+    for (auto idx : floatResult)
+        inFloat[idx] = true;
+
+    std::size_t mismatchedTriangles = 0, filterErrors = 0;
+    for (std::size_t idx = 0; idx < count; ++idx)
+    {
+        mismatchedTriangles += (inDouble[idx] != inFloat[idx]);
+        filterErrors += (inDouble[idx] != exactDouble[idx]) + (inFloat[idx] != exactFloat[idx]);
+    }
+
+    std::cout << "triangles:               " << count << "\n"
+              << "double time, ms:         " << doubleTime << "\n"
+              << "float time, ms:          " << floatTime << "\n"
+              << "intersecting (double):   " << doubleResult.size() << "\n"
+              << "intersecting (float):    " << floatResult.size() << "\n"
+              << "mismatched triangles:    " << mismatchedTriangles << "\n"
+              << "intersecting pairs:      " << pairs << "\n"
+              << "mismatched pairs:        " << mismatchedPairs << "\n"
+              << "pipeline vs exact test:  " << filterErrors << std::endl;
+}
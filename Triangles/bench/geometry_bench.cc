@@ -0,0 +1,257 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "distance_query.hh"
+#include "geometry3D.hh"
+#include "soups.hh"
+#include "triangle_soa.hh"
+
+// Microbenchmarks of the primitives, end-to-end runs of intersectingTriangles over the soups of soups.hh and
+// distance queries between two of them.
+// The end-to-end runs also report the pipeline's counters from one extra run with PipelineStats, which is
+// not part of the timing.
+
+namespace
+{
+
+using namespace geometry3D;
+
+// primitives are measured over this many inputs so that the branch predictor does not learn them
+constexpr std::size_t INPUTS = 1024;
+
+enum Soup
+{
+    RANDOM,
+    CLUSTERED,
+    NEAR_DEGENERATE
+};
+
+template <typename T>
+std::vector<Triangle3D<T>> makeSoup(std::size_t count, long kind)
+{
+    switch (kind)
+    {
+        case CLUSTERED:       return soups::clustered<T>(count);
+        case NEAR_DEGENERATE: return soups::nearDegenerate<T>(count);
+        default:              return soups::random<T>(count);
+    }
+}
+
+template <typename T>
+std::vector<Vector3D<T>> randomVectors(std::size_t count, std::mt19937& gen)
+{
+    std::uniform_real_distribution<T> coord{-10, 10};
+
+    std::vector<Vector3D<T>> vectors;
+    for (std::size_t i = 0; i < count; ++i)
+        vectors.push_back(Vector3D<T>{coord(gen), coord(gen), coord(gen)});
+
+    return vectors;
+}
+
+template <typename T>
+std::vector<Point3D<T>> randomPoints(std::size_t count, std::mt19937& gen)
+{
+    std::uniform_real_distribution<T> coord{-10, 10};
+
+    std::vector<Point3D<T>> points;
+    for (std::size_t i = 0; i < count; ++i)
+        points.push_back(Point3D<T>{coord(gen), coord(gen), coord(gen)});
+
+    return points;
+}
+
+template <typename T>
+void crossProduct(benchmark::State& state)
+{
+    std::mt19937 gen{1};
+    std::vector<Vector3D<T>> lhs = randomVectors<T>(INPUTS, gen), rhs = randomVectors<T>(INPUTS, gen);
+
+    for (auto _ : state)
+        for (std::size_t idx = 0; idx < INPUTS; ++idx)
+            benchmark::DoNotOptimize(lhs[idx].crossProduct(rhs[idx]));
+
+    state.SetItemsProcessed(state.iterations() * INPUTS);
+}
+
+// every pair of lines meets in a point, the case that runs the whole formula
+template <typename T>
+void lineLineIntersect(benchmark::State& state)
+{
+    std::mt19937 gen{2};
+    std::vector<Point3D<T>> meeting = randomPoints<T>(INPUTS, gen);
+    std::vector<Vector3D<T>> lhsDirections = randomVectors<T>(INPUTS, gen), rhsDirections = randomVectors<T>(INPUTS, gen);
+
+    std::vector<Line3D<T>> lhs, rhs;
+    for (std::size_t idx = 0; idx < INPUTS; ++idx)
+    {
+        lhs.push_back(Line3D<T>{lhsDirections[idx], meeting[idx]});
+        rhs.push_back(Line3D<T>{rhsDirections[idx], meeting[idx]});
+    }
+
+    for (auto _ : state)
+        for (std::size_t idx = 0; idx < INPUTS; ++idx)
+            benchmark::DoNotOptimize(geometry3D::lineLineIntersect(lhs[idx], rhs[idx]));
+
+    state.SetItemsProcessed(state.iterations() * INPUTS);
+}
+
+template <typename T>
+void planeLineIntersect(benchmark::State& state)
+{
+    std::mt19937 gen{3};
+    std::vector<Vector3D<T>> normals = randomVectors<T>(INPUTS, gen), directions = randomVectors<T>(INPUTS, gen);
+    std::vector<Point3D<T>> points = randomPoints<T>(INPUTS, gen);
+    std::uniform_real_distribution<T> coef{-10, 10};
+
+    std::vector<Plane3D<T>> planes;
+    std::vector<Line3D<T>> lines;
+    for (std::size_t idx = 0; idx < INPUTS; ++idx)
+    {
+        planes.push_back(Plane3D<T>{normals[idx], coef(gen)});
+        lines.push_back(Line3D<T>{directions[idx], points[idx]});
+    }
+
+    for (auto _ : state)
+        for (std::size_t idx = 0; idx < INPUTS; ++idx)
+            benchmark::DoNotOptimize(geometry3D::planeLineIntersect(planes[idx], lines[idx]));
+
+    state.SetItemsProcessed(state.iterations() * INPUTS);
+}
+
+// pairs of a soup with overlapping boxes, the ones the exact test gets after the broad phase
+template <typename T>
+void triangleTriangleIntersect(benchmark::State& state)
+{
+    std::vector<Triangle3D<T>> soup = makeSoup<T>(3000, state.range(0));
+
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (std::size_t first = 0; first < soup.size() && pairs.size() < INPUTS; ++first)
+        for (std::size_t second = first + 1; second < soup.size() && pairs.size() < INPUTS; ++second)
+            if (soup[first].box().overlaps(soup[second].box()))
+                pairs.emplace_back(first, second);
+
+    if (pairs.empty())
+    {
+        state.SkipWithError("no candidate pairs");
+        return;
+    }
+
+    // cached boxes are filled before timing, as they are in the pipeline
+    for (const Triangle3D<T>& tr : soup)
+        tr.box();
+
+    std::size_t hits = 0;
+
+    for (auto _ : state)
+        for (const auto& [first, second] : pairs)
+        {
+            bool hit = geometry3D::triangleTriangleIntersect(soup[first], soup[second]);
+            hits += hit;
+            benchmark::DoNotOptimize(hit);
+        }
+
+    state.SetItemsProcessed(state.iterations() * pairs.size());
+    state.counters["hit_rate"] = static_cast<double>(hits) / static_cast<double>(state.iterations() * pairs.size());
+}
+
+template <typename T>
+void intersectingTriangles(benchmark::State& state)
+{
+    TriangleSoA<T> soa = soups::toSoA(makeSoup<T>(static_cast<std::size_t>(state.range(0)), state.range(1)));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(geometry3D::intersectingTriangles(soa));
+
+    PipelineStats stats;
+    geometry3D::intersectingTriangles(soa, stats);
+
+    auto share = [&](std::uint64_t part, std::uint64_t whole)
+    {
+        return (whole == 0) ? 0.0 : static_cast<double>(part) / static_cast<double>(whole);
+    };
+
+    auto exact = [&](TriangleTestStage stage)
+    {
+        return share(stats.exactDecided[static_cast<std::size_t>(stage)], stats.reversePlaneSidePassed);
+    };
+
+    auto milliseconds = [](std::chrono::nanoseconds time)
+    {
+        return std::chrono::duration<double, std::milli>(time).count();
+    };
+
+    state.counters["candidates"] = static_cast<double>(stats.candidates);
+    state.counters["intersecting_pairs"] = static_cast<double>(stats.intersectingPairs);
+
+    // share of the pairs reaching a stage that get through it
+    state.counters["broad_pass"] = share(stats.candidates, stats.pairs);
+    state.counters["plane_pass"] = share(stats.planeSidePassed, stats.candidates);
+    state.counters["reverse_plane_pass"] = share(stats.reversePlaneSidePassed, stats.planeSidePassed);
+
+    // share of the exact tests decided by each of its stages
+    state.counters["exact_degenerate"] = exact(TriangleTestStage::Degenerate);
+    state.counters["exact_first_plane"] = exact(TriangleTestStage::FirstPlane);
+    state.counters["exact_second_plane"] = exact(TriangleTestStage::SecondPlane);
+    state.counters["exact_intervals"] = exact(TriangleTestStage::Intervals);
+    state.counters["exact_coplanar"] = exact(TriangleTestStage::Coplanar);
+
+    state.counters["broad_ms"] = milliseconds(stats.broadPhaseTime);
+    state.counters["filter_ms"] = milliseconds(stats.narrowPhaseTime);
+    state.counters["exact_ms"] = milliseconds(stats.exactTime);
+}
+
+// two soups side by side, the gap between them is about one triangle
+template <typename T>
+void closestPair(benchmark::State& state)
+{
+    std::size_t count = static_cast<std::size_t>(state.range(0));
+    std::vector<Triangle3D<T>> lhs = makeSoup<T>(count, state.range(1));
+    std::vector<Triangle3D<T>> rhs = makeSoup<T>(count, state.range(1));
+
+    T shift = soups::side(count, T{1}) + 3;
+    for (Triangle3D<T>& tr : rhs)
+        tr = Triangle3D<T>{soups::shifted(tr[0], shift, T{0}, T{0}), soups::shifted(tr[1], shift, T{0}, T{0}),
+                           soups::shifted(tr[2], shift, T{0}, T{0})};
+
+    DistanceScene<T> lhsScene{lhs}, rhsScene{rhs};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(lhsScene.closest(rhsScene));
+
+    state.counters["distance"] = static_cast<double>(lhsScene.closest(rhsScene).distance);
+}
+
+}
+
+BENCHMARK(crossProduct<float>);
+BENCHMARK(crossProduct<double>);
+BENCHMARK(lineLineIntersect<float>);
+BENCHMARK(lineLineIntersect<double>);
+BENCHMARK(planeLineIntersect<float>);
+BENCHMARK(planeLineIntersect<double>);
+
+BENCHMARK(triangleTriangleIntersect<float>)->ArgName("soup")->DenseRange(RANDOM, NEAR_DEGENERATE);
+BENCHMARK(triangleTriangleIntersect<double>)->ArgName("soup")->DenseRange(RANDOM, NEAR_DEGENERATE);
+
+BENCHMARK(intersectingTriangles<float>)
+    ->ArgNames({"triangles", "soup"})
+    ->ArgsProduct({{1000, 4000}, {RANDOM, CLUSTERED, NEAR_DEGENERATE}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(intersectingTriangles<double>)
+    ->ArgNames({"triangles", "soup"})
+    ->ArgsProduct({{1000, 4000}, {RANDOM, CLUSTERED, NEAR_DEGENERATE}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(closestPair<float>)
+    ->ArgNames({"triangles", "soup"})
+    ->ArgsProduct({{10000, 1000000}, {RANDOM, CLUSTERED}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(closestPair<double>)
+    ->ArgNames({"triangles", "soup"})
+    ->ArgsProduct({{10000, 1000000}, {RANDOM, CLUSTERED}})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,153 @@
+#ifndef SOUPS_HH
+#define SOUPS_HH
+
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "geometry3D.hh"
+#include "triangle_soa.hh"
+
+
+// Triangle soups for end-to-end runs. All of them spread count triangles of about size over a cube whose volume
+// grows with count, so the average number of neighbours stays the same and the soups differ only in how the
+// triangles are placed.
+namespace soups
+{
+
+using geometry3D::Point3D;
+using geometry3D::Triangle3D;
+
+// one center per 8 units of volume
+template <typename T>
+T side(std::size_t count, T size)
+{
+    return 2 * size * std::cbrt(static_cast<T>(count));
+}
+
+template <typename T>
+Point3D<T> shifted(const Point3D<T>& point, T dx, T dy, T dz)
+{
+    return Point3D<T>{point.coords[0] + dx, point.coords[1] + dy, point.coords[2] + dz};
+}
+
+// uniformly distributed centers
+template <typename T>
+std::vector<Triangle3D<T>> random(std::size_t count, T size = 1, unsigned seed = 1)
+{
+    std::mt19937 gen{seed};
+    std::uniform_real_distribution<T> position{0, side(count, size)};
+    std::uniform_real_distribution<T> offset{-size, size};
+
+    std::vector<Triangle3D<T>> soup;
+    soup.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Point3D<T> center{position(gen), position(gen), position(gen)};
+        soup.push_back(Triangle3D<T>{shifted(center, offset(gen), offset(gen), offset(gen)),
+                                     shifted(center, offset(gen), offset(gen), offset(gen)),
+                                     shifted(center, offset(gen), offset(gen), offset(gen))});
+    }
+
+    return soup;
+}
+
+// the same triangles packed into a few normally distributed clusters, giving many candidates per triangle
+template <typename T>
+std::vector<Triangle3D<T>> clustered(std::size_t count, std::size_t clusters = 8, T size = 1, unsigned seed = 1)
+{
+    std::mt19937 gen{seed};
+    std::uniform_real_distribution<T> position{0, side(count, size)};
+    std::normal_distribution<T> spread{0, side(count, size) / 20};
+    std::uniform_real_distribution<T> offset{-size, size};
+
+    std::vector<Point3D<T>> centers;
+    for (std::size_t cluster = 0; cluster < clusters; ++cluster)
+        centers.push_back(Point3D<T>{position(gen), position(gen), position(gen)});
+
+    std::vector<Triangle3D<T>> soup;
+    soup.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Point3D<T> center = shifted(centers[i % clusters], spread(gen), spread(gen), spread(gen));
+        soup.push_back(Triangle3D<T>{shifted(center, offset(gen), offset(gen), offset(gen)),
+                                     shifted(center, offset(gen), offset(gen), offset(gen)),
+                                     shifted(center, offset(gen), offset(gen), offset(gen))});
+    }
+
+    return soup;
+}
+
+// Cases the exact predicates exist for: slivers whose third vertex is within a relative 1e-6 of the opposite
+// edge, triangles lying almost in one plane with their neighbours, and segments and points.
+template <typename T>
+std::vector<Triangle3D<T>> nearDegenerate(std::size_t count, T size = 1, unsigned seed = 1)
+{
+    std::mt19937 gen{seed};
+    std::uniform_real_distribution<T> position{0, side(count, size)};
+    std::uniform_real_distribution<T> offset{-size, size};
+    std::uniform_real_distribution<T> tiny{T(-1e-6), T(1e-6)};
+    std::uniform_real_distribution<T> along{0, 1};
+
+    // a few planes, so that nearly coplanar triangles meet
+    constexpr int PLANES = 4;
+
+    std::vector<Triangle3D<T>> soup;
+    soup.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Point3D<T> center{position(gen), position(gen), position(gen)};
+        Point3D<T> a = shifted(center, offset(gen), offset(gen), offset(gen));
+        Point3D<T> b = shifted(center, offset(gen), offset(gen), offset(gen));
+
+        switch (i % 3)
+        {
+            case 0:
+            {
+                T t = along(gen);
+                Point3D<T> c{a.coords[0] + t * (b.coords[0] - a.coords[0]) + tiny(gen) * size,
+                             a.coords[1] + t * (b.coords[1] - a.coords[1]) + tiny(gen) * size,
+                             a.coords[2] + t * (b.coords[2] - a.coords[2]) + tiny(gen) * size};
+                soup.push_back(Triangle3D<T>{a, b, c});
+                break;
+            }
+            case 1:
+            {
+                T z = side(count, size) * static_cast<T>(i % PLANES + 1) / (PLANES + 1);
+                auto flat = [&](const Point3D<T>& point)
+                {
+                    return Point3D<T>{point.coords[0], point.coords[1], z + tiny(gen) * size};
+                };
+
+                soup.push_back(Triangle3D<T>{flat(a), flat(b), flat(shifted(center, offset(gen), offset(gen), T{0}))});
+                break;
+            }
+            default:
+                soup.push_back((i % 2 == 0) ? Triangle3D<T>{a, b, a} : Triangle3D<T>{a, a, a});
+        }
+    }
+
+    return soup;
+}
+
+template <typename T>
+geometry3D::TriangleSoA<T> toSoA(const std::vector<Triangle3D<T>>& soup)
+{
+    geometry3D::TriangleSoA<T> soa;
+    soa.reserve(soup.size());
+
+    for (const Triangle3D<T>& tr : soup)
+        soa.push_back(tr);
+
+    return soa;
+}
+
+}
+
+
+#endif
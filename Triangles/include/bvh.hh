@@ -0,0 +1,69 @@
+#ifndef BVH_HH
+#define BVH_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "geometry3D.hh"
+
+
+namespace geometry3D
+{
+
+// Plain box layout shared with the batched kernels: 32 bytes for float, a cache line holds two siblings.
+template <typename T>
+struct BVHNode
+{
+    T min[3];
+    T max[3];
+    // leaves: first entry of the primitive order; inner nodes: left child, the right one follows it
+    std::uint32_t first;
+    // 0 for inner nodes
+    std::uint32_t count;
+
+    bool leaf() const { return count != 0; }
+};
+
+// Bounding volume hierarchy over a set of boxes, built with the binned surface area heuristic.
+// Leaves refer to ranges of order(), which holds indices of the boxes given to build().
+template <typename T>
+class BVH
+{
+    std::vector<BVHNode<T>> nodes_;
+    std::vector<std::uint32_t> order_;
+
+public:
+
+    // no path from the root is longer, traversal stacks of this size never overflow
+    static constexpr std::size_t MAX_DEPTH = 64;
+    // leaves hold up to this many triangles, or up to 4 times as many where no split pays off
+    static constexpr std::uint32_t LEAF_SIZE = 4;
+
+    BVH() = default;
+
+    explicit BVH(std::span<const AABB3D<T>> boxes)
+    {
+        build(boxes);
+    }
+
+    // boxes must be valid
+    void build(std::span<const AABB3D<T>> boxes);
+
+    bool empty() const { return nodes_.empty(); }
+
+    const std::vector<BVHNode<T>>& nodes() const { return nodes_; }
+    const std::vector<std::uint32_t>& order() const { return order_; }
+
+private:
+
+    void subdivide(std::uint32_t nodeIdx, std::span<const AABB3D<T>> boxes, std::span<const T> centroids,
+                   std::size_t depth);
+};
+
+}
+
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef DISTANCE_QUERY_HH
+#define DISTANCE_QUERY_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bvh.hh"
+#include "geometry3D.hh"
+#include "triangle_soa.hh"
+
+
+namespace geometry3D
+{
+
+// Closest points of two primitives, first on the left one. Intersecting primitives are at distance 0 with both
+// points at a common point. Nothing found gives a nan distance, like the other queries returning invalid points.
+template <typename T>
+struct DistanceResult
+{
+    T distance = nan<T>;
+    Point3D<T> first;
+    Point3D<T> second;
+    std::size_t firstTriangle = 0;
+    std::size_t secondTriangle = 0;
+
+    constexpr bool valid() const
+    {
+        return floatValid(distance);
+    }
+};
+
+// Segments of coinciding ends are points. Primitives with invalid points have no distance; the triangle fields
+// are left 0. Instantiated for float and double.
+template <typename T>
+DistanceResult<T> segmentSegmentDistance(const Segment3D<T>& lhs, const Segment3D<T>& rhs);
+template <typename T>
+DistanceResult<T> pointTriangleDistance(const Point3D<T>& point, const Triangle3D<T>& tr);
+template <typename T>
+DistanceResult<T> triangleTriangleDistance(const Triangle3D<T>& lhs, const Triangle3D<T>& rhs);
+
+// Triangles with a bounding volume hierarchy for distance queries between two sets. Results report indices into
+// the triangles given to the constructors; triangles with invalid vertices are dropped on construction.
+//
+// The sets are triangle soups without an inside, so overlapping sets have no penetration depth: they are at
+// distance 0 with the witness points on their intersection.
+template <typename T>
+class DistanceScene
+{
+    BVH<T> bvh_;
+    // triangles in BVH leaf order
+    TriangleSoA<T> triangles_;
+    std::vector<std::size_t> ids_;
+    // every node's range of triangles_
+    std::vector<std::uint32_t> spanFirst_;
+    std::vector<std::uint32_t> spanCount_;
+
+public:
+
+    DistanceScene() = default;
+
+    explicit DistanceScene(std::span<const Triangle3D<T>> triangles);
+
+    std::size_t size() const { return ids_.size(); }
+
+    bool empty() const { return ids_.empty(); }
+
+    const BVH<T>& bvh() const { return bvh_; }
+
+    // The closest pair of a triangle of this scene and one of other, first on this scene's triangle. Only pairs
+    // closer than maxDistance are searched for, a smaller bound prunes more; invalid if there are none.
+    DistanceResult<T> closest(const DistanceScene& other, T maxDistance = inf<T>) const;
+
+private:
+
+    void computeSpans(std::uint32_t nodeIdx);
+};
+
+}
+
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef DYNAMIC_BVH_HH
+#define DYNAMIC_BVH_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "geometry3D.hh"
+
+
+namespace geometry3D
+{
+
+// Bounding volume hierarchy over boxes that are inserted, moved and removed one at a time.
+// Insertion picks the sibling with the smallest growth in surface area, as in Box2D's dynamic tree, and the nodes
+// above every change are rotated when that reduces their surface area (Kopta et al., "Fast, Effective BVH Updates
+// for Animated Scenes"). Leaves are identified by the node index insert() returns.
+template <typename T>
+class DynamicBVH
+{
+public:
+
+    using Index = std::uint32_t;
+
+    static constexpr Index NONE = std::numeric_limits<Index>::max();
+
+private:
+
+    struct Node
+    {
+        AABB3D<T> box;
+        Index parent = NONE;
+        Index left = NONE;
+        Index right = NONE;
+        // leaves only
+        Index item = NONE;
+        // 0 for leaves, free nodes have -1
+        int height = 0;
+
+        bool leaf() const { return left == NONE; }
+    };
+
+    std::vector<Node> nodes_;
+    Index root_ = NONE;
+    Index free_ = NONE;
+    std::size_t leaves_ = 0;
+
+public:
+
+    // returns the leaf holding item
+    Index insert(const AABB3D<T>& box, Index item);
+    void remove(Index leaf);
+    // changes the leaf's box and updates its ancestors without restructuring the tree
+    void refit(Index leaf, const AABB3D<T>& box);
+
+    const AABB3D<T>& box(Index leaf) const { return nodes_[leaf].box; }
+    Index item(Index leaf) const { return nodes_[leaf].item; }
+
+    std::size_t size() const { return leaves_; }
+    bool empty() const { return root_ == NONE; }
+    int height() const { return empty() ? 0 : nodes_[root_].height; }
+
+    // calls visit(item) for every leaf whose box overlaps the given one
+    template <typename Visit>
+    void query(const AABB3D<T>& box, Visit visit) const
+    {
+        if (empty())
+            return;
+
+        std::vector<Index> stack{root_};
+
+        while (!stack.empty())
+        {
+            const Node& node = nodes_[stack.back()];
+            stack.pop_back();
+
+            if (!node.box.overlaps(box))
+                continue;
+
+            if (node.leaf())
+                visit(node.item);
+            else
+            {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+private:
+
+    Index allocate();
+    void release(Index idx);
+
+    // recomputes boxes and heights from idx up to the root, rotating the nodes on the way
+    void fixUpwards(Index idx);
+    void rotate(Index idx);
+};
+
+}
+
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef DYNAMIC_SCENE_HH
+#define DYNAMIC_SCENE_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "dynamic_bvh.hh"
+#include "geometry3D.hh"
+
+
+namespace geometry3D
+{
+
+// Triangles edited between frames with the intersecting pairs kept up to date incrementally.
+// Edits only mark triangles; commit() re-tests the marked ones against their neighbours in a DynamicBVH and
+// reports how the set of intersecting pairs changed since the previous commit.
+//
+// Boxes in the tree are enlarged by margin on every side. A triangle that stays inside its enlarged box leaves the
+// tree untouched, one that moves a bit further only refits the boxes above it and only a triangle jumping out of
+// its old box is reinserted. Triangles with invalid vertices are kept but intersect nothing.
+template <typename T>
+class DynamicScene
+{
+public:
+
+    using Id = std::uint32_t;
+    // first < second
+    using Pair = std::pair<Id, Id>;
+
+    struct Changes
+    {
+        // sorted
+        std::vector<Pair> added;
+        std::vector<Pair> removed;
+    };
+
+private:
+
+    struct Entry
+    {
+        Triangle3D<T> triangle;
+        typename DynamicBVH<T>::Index leaf = DynamicBVH<T>::NONE;
+        // intersecting triangles as of the last commit
+        std::vector<Id> partners;
+        bool alive = true;
+        bool dirty = false;
+    };
+
+    T margin_;
+    DynamicBVH<T> tree_;
+
+    std::vector<Entry> entries_;
+    std::vector<Id> dirty_;
+    std::vector<Id> removed_;
+    // ids of removed triangles are reused only after the commit reporting their pairs
+    std::vector<Id> released_;
+    std::vector<Id> free_;
+    std::size_t size_ = 0;
+
+public:
+
+    explicit DynamicScene(T margin = T{0}) : margin_(margin)
+    {}
+
+    Id insert(const Triangle3D<T>& tr);
+    void update(Id id, const Triangle3D<T>& tr);
+    void remove(Id id);
+
+    std::size_t size() const { return size_; }
+
+    bool contains(Id id) const
+    {
+        return id < entries_.size() && entries_[id].alive;
+    }
+
+    const Triangle3D<T>& triangle(Id id) const { return entries_[id].triangle; }
+
+    // triangles intersecting the given one at the last commit
+    const std::vector<Id>& intersecting(Id id) const { return entries_[id].partners; }
+
+    const DynamicBVH<T>& tree() const { return tree_; }
+
+    Changes commit();
+
+private:
+
+    void place(Id id);
+    void markDirty(Id id);
+};
+
+}
+
+
+#endif
@@ -2,9 +2,12 @@
 #define GEOMETRY_3D_HH
 
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <array>
+#include <cstddef>
+#include <optional>
 
 
 namespace geometry3D
@@ -17,43 +20,64 @@ namespace geometry3D
         Z
     };
 
-    using float_t = double;
+    // float coordinates are accurate to ~7 digits, so their tolerance has to be coarser
+    template <typename T>
+    struct ScalarTraits;
 
-    constexpr float_t EPS = 1e-6;
-    constexpr auto nan = std::numeric_limits<float_t>::quiet_NaN();
-    constexpr auto inf = std::numeric_limits<float_t>::infinity();
+    template <>
+    struct ScalarTraits<float>
+    {
+        static constexpr float EPS = 1e-4f;
+    };
+
+    template <>
+    struct ScalarTraits<double>
+    {
+        static constexpr double EPS = 1e-6;
+    };
+
+    template <typename T>
+    constexpr T EPS = ScalarTraits<T>::EPS;
+    template <typename T>
+    constexpr T nan = std::numeric_limits<T>::quiet_NaN();
+    template <typename T>
+    constexpr T inf = std::numeric_limits<T>::infinity();
 
 
-    inline bool floatValid(float_t value)
+    template <typename T>
+    constexpr bool floatValid(T value)
     {
-        return(!std::isnan(value) && !std::isinf(value));
+        return (value == value) && (value != inf<T>) && (value != -inf<T>);
     }
 
-    inline bool floatEqual(float_t lhs, float_t rhs)
+    template <typename T>
+    constexpr bool floatEqual(T lhs, T rhs)
     {
-        return std::abs(lhs - rhs) < EPS;
+        return (lhs - rhs < EPS<T>) && (rhs - lhs < EPS<T>);
     }
 
-    inline bool floatZero(float_t lhs)
+    template <typename T>
+    constexpr bool floatZero(T lhs)
     {
-        return floatEqual(lhs, 0.0);
+        return floatEqual(lhs, T{0});
     }
 
+template <typename T>
 struct Point3D
 {
-    std::array<float_t, 3> coords = {nan, nan, nan};
+    std::array<T, 3> coords = {nan<T>, nan<T>, nan<T>};
 
-    bool valid() const
+    constexpr bool valid() const
     {
         return floatValid(coords[X]) && floatValid(coords[Y]) && floatValid(coords[Z]);
     }
 
-    void setInvalid()
+    constexpr void setInvalid()
     {
-        coords[X] = coords[Y] = coords[Z] = nan;
+        coords[X] = coords[Y] = coords[Z] = nan<T>;
     }
 
-    bool operator == (const Point3D& other) const
+    constexpr bool operator == (const Point3D& other) const
     {
         if ((valid() && !other.valid()) || (!valid() && other.valid()))
             return false;
@@ -66,7 +90,7 @@ struct Point3D
                (floatEqual(coords[Z], other.coords[Z]));
     }
 
-    Point3D& operator =(const Point3D& rhs)
+    constexpr Point3D& operator =(const Point3D& rhs)
     {
         coords[X] = rhs.coords[X];
         coords[Y] = rhs.coords[Y];
@@ -76,40 +100,41 @@ struct Point3D
     }
 };
 
+template <typename T>
 struct Vector3D
 {
-    std::array<float_t, 3> coords = {nan, nan, nan};
+    std::array<T, 3> coords = {nan<T>, nan<T>, nan<T>};
 
-    bool valid() const
+    constexpr bool valid() const
     {
         return floatValid(coords[X]) && floatValid(coords[Y]) && floatValid(coords[Z]);
     }
 
-    Vector3D() = default;
+    constexpr Vector3D() = default;
 
-    Vector3D(float_t firstCoord, float_t secondCoord, float_t thirdCoord)
+    constexpr Vector3D(T firstCoord, T secondCoord, T thirdCoord)
     {
         coords[X] = firstCoord;
         coords[Y] = secondCoord;
         coords[Z] = thirdCoord;
     }
 
-    Vector3D(Point3D start, Point3D end) : Vector3D{end.coords[X] - start.coords[X],
-                                                    end.coords[Y] - start.coords[Y],
-                                                    end.coords[Z] - start.coords[Z]}
+    constexpr Vector3D(Point3D<T> start, Point3D<T> end) : Vector3D{end.coords[X] - start.coords[X],
+                                                                    end.coords[Y] - start.coords[Y],
+                                                                    end.coords[Z] - start.coords[Z]}
     {}
 
     Vector3D& makeUnit()
     {
         if (valid())
         {
-            float_t module = std::sqrt(scalarProduct(*this));
+            T module = std::sqrt(scalarProduct(*this));
             (*this) /= module;
         }
         return *this;
     }
 
-    Vector3D& operator += (const Vector3D& other)
+    constexpr Vector3D& operator += (const Vector3D& other)
     {
         coords[X] += other.coords[X];
         coords[Y] += other.coords[Y];
@@ -118,7 +143,7 @@ struct Vector3D
         return *this;
     }
 
-    Vector3D& operator -= (const Vector3D& other)
+    constexpr Vector3D& operator -= (const Vector3D& other)
     {
         coords[X] -= other.coords[X];
         coords[Y] -= other.coords[Y];
@@ -127,7 +152,7 @@ struct Vector3D
         return *this;
     }
 
-    Vector3D& operator *= (float_t scale)
+    constexpr Vector3D& operator *= (T scale)
     {
         coords[X] *= scale;
         coords[Y] *= scale;
@@ -136,7 +161,7 @@ struct Vector3D
         return *this;
     }
 
-    Vector3D& operator /= (float_t scale)
+    constexpr Vector3D& operator /= (T scale)
     {
         coords[X] /= scale;
         coords[Y] /= scale;
@@ -145,32 +170,32 @@ struct Vector3D
         return *this;
     }
 
-    float_t scalarProduct(const Vector3D& other) const
+    constexpr T scalarProduct(const Vector3D& other) const
     {
-        return coords[X] * other.coords[X] + coords[Y] * other.coords[Y] + coords[Z] * other.coords[Z]; 
+        return coords[X] * other.coords[X] + coords[Y] * other.coords[Y] + coords[Z] * other.coords[Z];
     }
 
-    Vector3D crossProduct(const Vector3D& other) const
+    constexpr Vector3D crossProduct(const Vector3D& other) const
     {
         return Vector3D{coords[Y] * other.coords[Z] - coords[Z] * other.coords[Y],
                         coords[Z] * other.coords[X] - coords[X] * other.coords[Z],
                         coords[X] * other.coords[Y] - coords[Y] * other.coords[X]};
     }
 
-    bool operator == (const Vector3D& other) const
+    constexpr bool operator == (const Vector3D& other) const
     {
             return (floatEqual(coords[X], other.coords[X])) &&
                    (floatEqual(coords[Y], other.coords[Y])) &&
                    (floatEqual(coords[Z], other.coords[Z]));
     }
 
-    Vector3D operator+ (const Vector3D& rhs)
+    constexpr Vector3D operator+ (const Vector3D& rhs) const
     {
         Vector3D tmp{*this};
         return tmp += rhs;
     }
 
-    Vector3D operator- (const Vector3D& rhs)
+    constexpr Vector3D operator- (const Vector3D& rhs) const
     {
         Vector3D tmp{*this};
         return tmp -= rhs;
@@ -179,27 +204,30 @@ struct Vector3D
 };
 
 
-inline Vector3D operator * (float_t scale, const Vector3D& rhs)
+template <typename T>
+constexpr Vector3D<T> operator * (T scale, const Vector3D<T>& rhs)
 {
-    Vector3D tmp{rhs};
+    Vector3D<T> tmp{rhs};
     return tmp *= scale;
 }
 
-inline Vector3D operator * (const Vector3D& rhs, float_t scale)
+template <typename T>
+constexpr Vector3D<T> operator * (const Vector3D<T>& rhs, T scale)
 {
-    Vector3D tmp{rhs};
+    Vector3D<T> tmp{rhs};
     return tmp *= scale;
 }
 
+template <typename T>
 struct Segment3D
 {
-    Point3D a;
-    Point3D b;
+    Point3D<T> a;
+    Point3D<T> b;
 
-    Segment3D(Point3D first, Point3D second) : a(first), b(second)
+    constexpr Segment3D(Point3D<T> first, Point3D<T> second) : a(first), b(second)
     {}
 
-    float_t len() const
+    T len() const
     {
         return std::sqrt((a.coords[X] - b.coords[X]) * (a.coords[X] - b.coords[X]) +
                          (a.coords[Y] - b.coords[Y]) * (a.coords[Y] - b.coords[Y]) +
@@ -208,51 +236,52 @@ struct Segment3D
 
 
     #if MAKE_GOOD_FILE_DISTRIB
-        bool containsPoint(const Point3D& toCheck) const
+        bool containsPoint(const Point3D<T>& toCheck) const
         {
-            if(!Line3D{a, b}.containsPoint(toCheck))
+            if(!Line3D<T>{a, b}.containsPoint(toCheck))
                 return false;
 
-            return Vector3D{a, toCheck}.scalarProduct(Vector3D{b, toCheck}) < 0;
+            return Vector3D<T>{a, toCheck}.scalarProduct(Vector3D<T>{b, toCheck}) < 0;
         }
     #endif
 };
 
+template <typename T>
 struct Line3D
 {
-    Vector3D direction;
-    Point3D point;
+    Vector3D<T> direction;
+    Point3D<T> point;
 
-    Line3D() = default;
+    constexpr Line3D() = default;
 
-    Line3D(Vector3D vec, Point3D startingPoint) : direction(vec), point(startingPoint)
+    constexpr Line3D(Vector3D<T> vec, Point3D<T> startingPoint) : direction(vec), point(startingPoint)
     {}
 
-    Line3D(Segment3D segment) : Line3D{Vector3D{segment.a, segment.b}, segment.b}
+    constexpr Line3D(Segment3D<T> segment) : Line3D{Vector3D<T>{segment.a, segment.b}, segment.b}
     {}
 
-    bool valid() const
+    constexpr bool valid() const
     {
         return direction.valid() && point.valid();
     }
 
-    bool collinearToVector(const Vector3D& rhs) const
+    constexpr bool collinearToVector(const Vector3D<T>& rhs) const
     {
-        if (direction.crossProduct(rhs) == Vector3D{0.0, 0.0, 0.0})
+        if (direction.crossProduct(rhs) == Vector3D<T>{0.0, 0.0, 0.0})
             return true;
 
         return false;
     }
 
-    bool containsPoint(const Point3D& toCheck) const
+    constexpr bool containsPoint(const Point3D<T>& toCheck) const
     {
-        if (Line3D{Vector3D{point, toCheck}, toCheck}.collinearToVector(direction))
+        if (Line3D{Vector3D<T>{point, toCheck}, toCheck}.collinearToVector(direction))
             return true;
-        
+
         return false;
     }
 
-    bool containsSegment(const Segment3D& toCheck) const
+    constexpr bool containsSegment(const Segment3D<T>& toCheck) const
     {
         return containsPoint(toCheck.a) && containsPoint(toCheck.b);
     }
@@ -260,54 +289,147 @@ struct Line3D
 };
 
 // (norm * r) + d = 0, where * - dot product
+template <typename T>
 struct Plane3D
 {
-    Vector3D norm;
-    float_t d;
+    Vector3D<T> norm;
+    T d;
 
-    Plane3D(Vector3D normal, float_t freeCoef) : norm(normal.makeUnit()), d(freeCoef)
+    Plane3D(Vector3D<T> normal, T freeCoef) : norm(normal.makeUnit()), d(freeCoef)
     {}
 
-    bool operator== (const Plane3D& other) const
+    constexpr bool operator== (const Plane3D& other) const
     {
         return (norm == other.norm) && (d == other.d);
     }
 
-    bool valid() const
+    constexpr bool valid() const
     {
         return norm.valid() && floatValid(d);
     }
 };
 
-class Triangle3D
+template <typename T>
+struct AABB3D
 {
-    Point3D points_[3];
+    Point3D<T> min;
+    Point3D<T> max;
 
-    Segment3D ab;
-    Segment3D bc;
-    Segment3D ac;
+    constexpr bool overlaps(const AABB3D& other) const
+    {
+        for (int axis = 0; axis < 3; ++axis)
+            if (min.coords[axis] > other.max.coords[axis] + EPS<T> ||
+                other.min.coords[axis] > max.coords[axis] + EPS<T>)
+                return false;
 
-    // bool valid_ = false;
+        return true;
+    }
+};
+
+// Only the vertices are stored, the bounding box is computed on first request and kept for the following
+// intersection queries. The cache is filled without locking, so a triangle shared between threads should have
+// it computed before it is shared. The supporting plane is computed on every request, the exact intersection
+// test does not use it.
+template <typename T>
+class Triangle3D
+{
+    Point3D<T> points_[3];
+
+    mutable std::optional<AABB3D<T>> box_;
 
 public:
 
-    Triangle3D(Point3D a, Point3D b, Point3D c) : ab(a, b), bc(b, c), ac(a, c)
+    constexpr Triangle3D(Point3D<T> a, Point3D<T> b, Point3D<T> c) : points_{a, b, c}
+    {}
+
+    constexpr const Point3D<T>& operator[](std::size_t idx) const
+    {
+        return points_[idx];
+    }
+
+    constexpr bool valid() const
     {
-        points_[0] = a;
-        points_[1] = b;
-        points_[2] = c;
+        return points_[0].valid() && points_[1].valid() && points_[2].valid();
     }
 
-    
+    // unnormalized, its length is twice the area
+    constexpr Vector3D<T> normal() const
+    {
+        return Vector3D<T>{points_[0], points_[1]}.crossProduct(Vector3D<T>{points_[0], points_[2]});
+    }
+
+    // invalid for degenerate triangle
+    Plane3D<T> plane() const
+    {
+        Vector3D<T> norm = normal();
+
+        if (floatZero(std::sqrt(norm.scalarProduct(norm))))
+            return Plane3D<T>{Vector3D<T>{}, nan<T>};
+
+        norm.makeUnit();
+        return Plane3D<T>{norm, -norm.scalarProduct(Vector3D<T>{points_[0].coords[X],
+                                                                points_[0].coords[Y],
+                                                                points_[0].coords[Z]})};
+    }
+
+    bool degenerate() const
+    {
+        return !plane().valid();
+    }
+
+    const AABB3D<T>& box() const
+    {
+        if (!box_)
+        {
+            AABB3D<T> box{points_[0], points_[0]};
+
+            for (int vertex = 1; vertex < 3; ++vertex)
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    box.min.coords[axis] = std::min(box.min.coords[axis], points_[vertex].coords[axis]);
+                    box.max.coords[axis] = std::max(box.max.coords[axis], points_[vertex].coords[axis]);
+                }
+
+            box_ = box;
+        }
+
+        return *box_;
+    }
+};
+
+// defined in intersections.cc, instantiated for float and double
+template <typename T>
+Point3D<T> lineLineIntersect(const Line3D<T>& lhs, const Line3D<T>& rhs);
+template <typename T>
+Point3D<T> planeLineIntersect(const Plane3D<T>& plain, const Line3D<T>& line);
+template <typename T>
+Point3D<T> planeLineIntersect(const Line3D<T>& line, const Plane3D<T>& plain);
+template <typename T>
+bool planePointIntersect(const Plane3D<T>& plain, const Point3D<T>& point);
+template <typename T>
+bool planePointIntersect(const Point3D<T>& point, const Plane3D<T>& plain);
+template <typename T>
+bool triangleTriangleIntersect(const Triangle3D<T>& lhs, const Triangle3D<T>& rhs);
+
+// stage of triangleTriangleIntersect that decided a pair, in the order they are tried
+enum class TriangleTestStage
+{
+    // boxes are disjoint
+    Boxes,
+    // one of the triangles is a segment or a point, or has an invalid vertex
+    Degenerate,
+    // the first triangle is on one side of the second one's plane, then the other way round
+    FirstPlane,
+    SecondPlane,
+    // the intervals on the planes' common line are compared
+    Intervals,
+    Coplanar
 };
 
-Point3D lineLineIntersect(const Line3D lhs, const Line3D rhs);
-Point3D planeLineIntersect(const Plane3D& plain, const Line3D& line);
-Point3D planeLineIntersect(const Line3D& line, const Plane3D& plain);
-bool planePointIntersect(const Plane3D& plain, const Point3D& point);
-bool planePointIntersect(const Point3D& point, const Plane3D& plain);
+template <typename T>
+bool triangleTriangleIntersect(const Triangle3D<T>& lhs, const Triangle3D<T>& rhs, TriangleTestStage& stage);
 
 }
 
 
-#endif
\ No newline at end of file
+#endif
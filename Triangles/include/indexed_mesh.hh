@@ -0,0 +1,127 @@
+#ifndef INDEXED_MESH_HH
+#define INDEXED_MESH_HH
+
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "geometry3D.hh"
+
+
+namespace geometry3D
+{
+
+// Mesh as a buffer of unique vertices and faces referring to them by 32-bit indices.
+// Faces sharing a vertex index are adjacent: they are connected by construction and are never
+// reported as intersecting each other.
+template <typename T>
+class IndexedMesh
+{
+public:
+
+    using Index = std::uint32_t;
+    using Face = std::array<Index, 3>;
+
+private:
+
+    std::vector<Point3D<T>> vertices_;
+    std::vector<Face> faces_;
+
+public:
+
+    IndexedMesh() = default;
+
+    IndexedMesh(std::vector<Point3D<T>> vertices, std::vector<Face> faces) :
+        vertices_(std::move(vertices)), faces_(std::move(faces))
+    {}
+
+    // welds vertices with exactly equal coordinates
+    template <typename It>
+    static IndexedMesh fromTriangles(It begin, It end)
+    {
+        IndexedMesh mesh;
+        std::unordered_map<std::array<T, 3>, Index, CoordsHash> known;
+
+        for (; begin != end; ++begin)
+        {
+            const Triangle3D<T>& tr = *begin;
+            Face face;
+
+            for (int vertex = 0; vertex < 3; ++vertex)
+            {
+                auto [it, inserted] = known.try_emplace(tr[vertex].coords, static_cast<Index>(mesh.vertices_.size()));
+                if (inserted)
+                    mesh.vertices_.push_back(tr[vertex]);
+
+                face[vertex] = it->second;
+            }
+
+            mesh.faces_.push_back(face);
+        }
+
+        return mesh;
+    }
+
+    Index addVertex(const Point3D<T>& vertex)
+    {
+        vertices_.push_back(vertex);
+        return static_cast<Index>(vertices_.size() - 1);
+    }
+
+    void addFace(Index a, Index b, Index c)
+    {
+        faces_.push_back(Face{a, b, c});
+    }
+
+    std::size_t vertexCount() const { return vertices_.size(); }
+    std::size_t faceCount() const { return faces_.size(); }
+
+    const Point3D<T>& vertex(Index idx) const { return vertices_[idx]; }
+    const Face& face(std::size_t idx) const { return faces_[idx]; }
+
+    Triangle3D<T> triangle(std::size_t idx) const
+    {
+        const Face& face = faces_[idx];
+        return Triangle3D<T>{vertices_[face[0]], vertices_[face[1]], vertices_[face[2]]};
+    }
+
+    bool adjacent(std::size_t lhs, std::size_t rhs) const
+    {
+        for (Index first : faces_[lhs])
+            for (Index second : faces_[rhs])
+                if (first == second)
+                    return true;
+
+        return false;
+    }
+
+private:
+
+    struct CoordsHash
+    {
+        std::size_t operator()(const std::array<T, 3>& coords) const
+        {
+            std::size_t seed = 0;
+            for (T coord : coords)
+            {
+                // +0.0 and -0.0 are equal keys, so they must hash alike
+                T value = (coord == T{0}) ? T{0} : coord;
+                seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+            return seed;
+        }
+    };
+};
+
+// indices of faces intersecting at least one non-adjacent face, ascending; instantiated for float and double
+template <typename T>
+std::vector<std::size_t> intersectingTriangles(const IndexedMesh<T>& mesh);
+
+}
+
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef LINE_BATCH_HH
+#define LINE_BATCH_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "geometry3D.hh"
+
+
+namespace geometry3D
+{
+
+// Lines stored as 6 component arrays, padded like TriangleSoA.
+// Lines are validated once on insertion: an invalid line is stored with a zero direction,
+// which every batched test rejects, so the kernels never check validity themselves.
+template <typename T>
+class LineBatch
+{
+    std::vector<T> point_[3];
+    std::vector<T> direction_[3];
+    std::size_t size_ = 0;
+
+public:
+
+    static constexpr std::size_t SIMD_PADDING = 16;
+
+    LineBatch()
+    {
+        resize(0);
+    }
+
+    std::size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    void reserve(std::size_t capacity)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            point_[axis].reserve(capacity + SIMD_PADDING);
+            direction_[axis].reserve(capacity + SIMD_PADDING);
+        }
+    }
+
+    void clear()
+    {
+        size_ = 0;
+        resize(0);
+    }
+
+    void push_back(const Line3D<T>& line)
+    {
+        resize(size_ + 1);
+
+        // written either way, the slot may hold a line from before clear()
+        bool valid = line.valid();
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            point_[axis][size_] = valid ? line.point.coords[axis] : T{0};
+            direction_[axis][size_] = valid ? line.direction.coords[axis] : T{0};
+        }
+
+        size_++;
+    }
+
+    const T* point(Axis axis) const { return point_[axis].data(); }
+    const T* direction(Axis axis) const { return direction_[axis].data(); }
+
+private:
+
+    void resize(std::size_t size)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            point_[axis].resize(size + SIMD_PADDING, T{0});
+            direction_[axis].resize(size + SIMD_PADDING, T{0});
+        }
+    }
+};
+
+// Points stored as 3 component arrays, padded like TriangleSoA. Invalid points are stored as nan and lie on no plane.
+template <typename T>
+class PointBatch
+{
+    std::vector<T> coords_[3];
+    std::size_t size_ = 0;
+
+public:
+
+    static constexpr std::size_t SIMD_PADDING = 16;
+
+    PointBatch()
+    {
+        resize(0);
+    }
+
+    std::size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    void reserve(std::size_t capacity)
+    {
+        for (auto& component : coords_)
+            component.reserve(capacity + SIMD_PADDING);
+    }
+
+    void clear()
+    {
+        size_ = 0;
+        resize(0);
+    }
+
+    void push_back(const Point3D<T>& point)
+    {
+        resize(size_ + 1);
+
+        for (int axis = 0; axis < 3; ++axis)
+            coords_[axis][size_] = point.valid() ? point.coords[axis] : nan<T>;
+
+        size_++;
+    }
+
+    const T* coord(Axis axis) const { return coords_[axis].data(); }
+
+private:
+
+    void resize(std::size_t size)
+    {
+        for (auto& component : coords_)
+            component.resize(size + SIMD_PADDING, T{0});
+    }
+};
+
+// Caller-owned results of a batched line query, every span at least as long as the batch; the queries throw
+// std::length_error for a shorter one.
+// hit[i] is 1 if the i-th line produced a point, the coordinates of misses are unspecified.
+template <typename T>
+struct IntersectionOutput
+{
+    std::span<T> x;
+    std::span<T> y;
+    std::span<T> z;
+    std::span<std::uint8_t> hit;
+};
+
+// Batched versions of the scalar functions from geometry3D.hh, instantiated for float and double.
+// An invalid plane or query line misses every element of the batch.
+
+template <typename T>
+void planeLineIntersect(const Plane3D<T>& plane, const LineBatch<T>& lines, IntersectionOutput<T> out);
+// the points lie on the query line
+template <typename T>
+void lineLineIntersect(const Line3D<T>& query, const LineBatch<T>& lines, IntersectionOutput<T> out);
+template <typename T>
+void planePointIntersect(const Plane3D<T>& plane, const PointBatch<T>& points, std::span<std::uint8_t> hit);
+
+}
+
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef MORTON_HH
+#define MORTON_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "geometry3D.hh"
+#include "triangle_soa.hh"
+
+
+// Morton (Z-order) codes interleave the bits of three coordinates, x in the lowest bit. Points close in space
+// mostly get close codes, so triangles sorted by the codes of their centroids have their neighbours nearby in
+// memory, which is what traversals over them touch.
+namespace geometry3D
+{
+
+// bits per coordinate, 63 bits in a code
+constexpr unsigned MORTON_BITS = 21;
+
+// inserts two zero bits above each of the low MORTON_BITS bits
+constexpr std::uint64_t mortonSpread(std::uint32_t coord)
+{
+    std::uint64_t bits = coord & ((std::uint64_t{1} << MORTON_BITS) - 1);
+
+    bits = (bits | bits << 32) & 0x1f00000000ffffull;
+    bits = (bits | bits << 16) & 0x1f0000ff0000ffull;
+    bits = (bits | bits << 8) & 0x100f00f00f00f00full;
+    bits = (bits | bits << 4) & 0x10c30c30c30c30c3ull;
+    bits = (bits | bits << 2) & 0x1249249249249249ull;
+
+    return bits;
+}
+
+constexpr std::uint64_t mortonCode(std::uint32_t x, std::uint32_t y, std::uint32_t z)
+{
+    return mortonSpread(x) | mortonSpread(y) << 1 | mortonSpread(z) << 2;
+}
+
+// Codes of the triangles' centroids on a grid of 2^21 cells per axis spanning the centroids' bounds.
+// Triangles with invalid vertices get the largest code, so they sort last. Computed by up to threads threads,
+// 0 picks the number of hardware threads, fewer for small inputs. Instantiated for float and double.
+template <typename T>
+std::vector<std::uint64_t> mortonCodes(const TriangleSoA<T>& soa, std::size_t threads = 0);
+template <typename T>
+std::vector<std::uint64_t> mortonCodes(std::span<const Triangle3D<T>> triangles, std::size_t threads = 0);
+
+// Stable least significant digit radix sort with 8-bit digits; every pass counts the digits of the chunks in
+// parallel and scatters them in parallel, passes where all codes share the digit are skipped. Returns the
+// indices of the codes in ascending order of the codes. At most 2^32 codes, threads as in mortonCodes.
+std::vector<std::uint32_t> sortByCode(std::span<const std::uint64_t> codes, std::size_t threads = 0);
+
+// Triangles in Morton order with the way back to the input order, so any engine can run on the sorted
+// triangles and report its results against the input.
+template <typename T>
+struct MortonSorted
+{
+    TriangleSoA<T> triangles;
+    // input index of every sorted triangle
+    std::vector<std::uint32_t> original;
+
+    // input indices of the given sorted ones, ascending
+    std::vector<std::size_t> originalIndices(const std::vector<std::size_t>& sorted) const;
+};
+
+template <typename T>
+MortonSorted<T> mortonSort(const TriangleSoA<T>& soa, std::size_t threads = 0);
+
+}
+
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef PARALLEL_HH
+#define PARALLEL_HH
+
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+namespace geometry3D
+{
+
+// runs task(chunk) for every chunk on its own thread, the first exception is rethrown once all of them finished
+template <typename Task>
+void runChunks(std::size_t chunks, Task task)
+{
+    std::vector<std::exception_ptr> errors(chunks);
+    std::vector<std::thread> threads;
+
+    auto guarded = [&](std::size_t chunk)
+    {
+        try
+        {
+            task(chunk);
+        }
+        catch (...)
+        {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+        threads.emplace_back(guarded, chunk);
+
+    guarded(0);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+
+}
+
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef PREDICATES_HH
+#define PREDICATES_HH
+
+
+#include <array>
+
+#include "geometry3D.hh"
+
+
+// Exact orientation predicates after J. R. Shewchuk, "Adaptive Precision Floating-Point Arithmetic and
+// Fast Robust Geometric Predicates". The determinant is evaluated in plain doubles together with a bound
+// on its rounding error; only if the bound cannot certify the sign it is recomputed with exact expansion
+// arithmetic. float input is promoted to double, which is exact.
+namespace geometry3D
+{
+
+    // > 0 if a, b, c go counterclockwise, < 0 if clockwise, 0 if collinear
+    int orient2d(double ax, double ay, double bx, double by, double cx, double cy);
+
+    // > 0 if d lies below the plane through a, b, c, where "below" means a, b, c go counterclockwise
+    // when viewed from above; 0 if the four points are coplanar.
+    // Equals the sign of (a - d) * ((b - d) x (c - d)).
+    int orient3d(const double* a, const double* b, const double* c, const double* d);
+
+    template <typename T>
+    int orient3d(const Point3D<T>& a, const Point3D<T>& b, const Point3D<T>& c, const Point3D<T>& d)
+    {
+        auto promote = [](const Point3D<T>& point)
+        {
+            return std::array<double, 3>{point.coords[X], point.coords[Y], point.coords[Z]};
+        };
+
+        std::array<double, 3> pa = promote(a), pb = promote(b), pc = promote(c), pd = promote(d);
+        return orient3d(pa.data(), pb.data(), pc.data(), pd.data());
+    }
+
+}
+
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef RAY_HH
+#define RAY_HH
+
+
+#include <cstddef>
+
+#include "geometry3D.hh"
+
+
+// Ray and hit types shared by the ray queries and their batched kernels.
+namespace geometry3D
+{
+
+// points origin + direction * t with tMin <= t < tMax
+template <typename T>
+struct Ray3D
+{
+    Point3D<T> origin;
+    Vector3D<T> direction;
+    T tMin = 0;
+    T tMax = inf<T>;
+
+    constexpr bool valid() const
+    {
+        return origin.valid() && direction.valid() && tMin == tMin && tMax == tMax;
+    }
+};
+
+// The hit point is origin + direction * t = (1 - u - v) * tr[0] + u * tr[1] + v * tr[2].
+// A miss has nan t, like the other queries returning invalid points.
+template <typename T>
+struct RayHit
+{
+    T t = nan<T>;
+    T u = nan<T>;
+    T v = nan<T>;
+    std::size_t triangle = 0;
+
+    constexpr bool valid() const
+    {
+        return floatValid(t);
+    }
+};
+
+}
+
+
+#endif
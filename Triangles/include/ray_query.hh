@@ -0,0 +1,71 @@
+#ifndef RAY_QUERY_HH
+#define RAY_QUERY_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bvh.hh"
+#include "geometry3D.hh"
+#include "ray.hh"
+
+
+namespace geometry3D
+{
+
+// Moller-Trumbore test, rays parallel to the triangle's plane miss it; the triangle field is left 0.
+// Instantiated for float and double.
+template <typename T>
+RayHit<T> rayTriangleIntersect(const Ray3D<T>& ray, const Triangle3D<T>& tr);
+
+// Triangles with a bounding volume hierarchy for ray casting. Hits report indices into the triangles given to the
+// constructor; triangles with invalid vertices are dropped on construction and are never hit.
+//
+// The span overloads trace the rays in packets of one SIMD register each (4 or 8 rays with AVX2, 8 or 16 with
+// AVX-512, for double and float). A packet descends as long as one of its rays does, so neighbouring rays should
+// be close in origin and direction, like rows of pixels or samples around the same point.
+template <typename T>
+class RayScene
+{
+    BVH<T> bvh_;
+    // Moller-Trumbore input in BVH leaf order: tr[0], tr[1] - tr[0] and tr[2] - tr[0]
+    std::vector<T> vertex_[3];
+    std::vector<T> edge1_[3];
+    std::vector<T> edge2_[3];
+    std::vector<std::size_t> ids_;
+
+public:
+
+    RayScene() = default;
+
+    explicit RayScene(std::span<const Triangle3D<T>> triangles);
+
+    std::size_t size() const { return ids_.size(); }
+
+    bool empty() const { return ids_.empty(); }
+
+    const BVH<T>& bvh() const { return bvh_; }
+
+    // nearest hit with t in [tMin, tMax)
+    RayHit<T> closestHit(const Ray3D<T>& ray) const;
+    // some hit with t in [tMin, tMax), traversal stops at the first one found
+    bool anyHit(const Ray3D<T>& ray) const;
+    // all hits with t in [tMin, tMax) sorted by t
+    std::vector<RayHit<T>> allHits(const Ray3D<T>& ray) const;
+
+    // out must be at least as long as rays
+    void closestHit(std::span<const Ray3D<T>> rays, std::span<RayHit<T>> out) const;
+    void anyHit(std::span<const Ray3D<T>> rays, std::span<std::uint8_t> out) const;
+
+    const T* vertex(Axis axis) const { return vertex_[axis].data(); }
+    const T* edge1(Axis axis) const { return edge1_[axis].data(); }
+    const T* edge2(Axis axis) const { return edge2_[axis].data(); }
+    const std::size_t* ids() const { return ids_.data(); }
+};
+
+}
+
+
+#endif
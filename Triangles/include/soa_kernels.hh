@@ -0,0 +1,874 @@
+#ifndef SOA_KERNELS_HH
+#define SOA_KERNELS_HH
+
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "bvh.hh"
+#include "ray.hh"
+
+
+// Batched kernels shared by all instruction sets. Every instruction set's translation unit instantiates them
+// with its own policy and defines GEOMETRY_KERNEL_ISA before including this header, which puts the kernels in an
+// inline namespace of that name.
+//
+// The wider instruction sets are not enabled for their whole translation units: those also define
+// GEOMETRY_KERNEL_TARGET, a gcc target string, and only the kernels and the policies are compiled for it. Inline
+// functions of other headers the kernels call, like Point3D::valid or std::popcount, are defined before the
+// target is switched, so the out-of-line copies the linker may pick for any caller run on every CPU.
+//
+// A policy provides:
+//     value_type, reg, mask, WIDTH
+//     load, store, set1, add, sub, mul, div, min, max, abs, sqrt
+//     lt, gt, le, ge (ordered comparisons, false on nan), andMask, orMask, notMask, trueMask, bits
+//     select(mask, a, b): a in the lanes where mask is set, b in the others
+#ifndef GEOMETRY_KERNEL_ISA
+#define GEOMETRY_KERNEL_ISA scalar
+#endif
+
+namespace geometry3D::kernels
+{
+
+template <typename T>
+struct SoAView
+{
+    const T* coord[3][3];
+};
+
+template <typename T>
+struct QueryData
+{
+    T vertex[3][3];
+    T min[3];
+    T max[3];
+
+    // (vertex[1] - vertex[0]) x (vertex[2] - vertex[0]) and the sums of the magnitudes of the products in every
+    // of its components, which bound the rounding errors of the plane side tests
+    T normal[3];
+    T normalTerms[3];
+
+    // slack of the box test
+    T eps;
+};
+
+template <typename T>
+struct LineView
+{
+    const T* point[3];
+    const T* direction[3];
+};
+
+template <typename T>
+struct PointView
+{
+    const T* coord[3];
+};
+
+template <typename T>
+struct PointOutput
+{
+    T* coord[3];
+    std::uint8_t* hit;
+};
+
+template <typename T>
+struct PlaneData
+{
+    T norm[3];
+    T d;
+    T eps;
+};
+
+template <typename T>
+struct LineData
+{
+    T point[3];
+    T direction[3];
+    T eps;
+};
+
+template <typename T>
+struct RaySceneView
+{
+    const BVHNode<T>* nodes;
+    const T* vertex[3];
+    const T* edge1[3];
+    const T* edge2[3];
+    const std::size_t* ids;
+};
+
+template <typename T>
+struct KernelTable
+{
+    using Kernel = void (*)(const QueryData<T>&, const SoAView<T>&, std::size_t, std::size_t, std::uint8_t*);
+
+    Kernel aabbOverlap;
+    Kernel planeSide;
+    // aabbOverlap, planeSide and planeSide with the roles of the triangles swapped
+    Kernel narrowPhaseFilter;
+
+    void (*planeLine)(const PlaneData<T>&, const LineView<T>&, std::size_t, const PointOutput<T>&);
+    void (*lineLine)(const LineData<T>&, const LineView<T>&, std::size_t, const PointOutput<T>&);
+    void (*planePoint)(const PlaneData<T>&, const PointView<T>&, std::size_t, std::uint8_t*);
+
+    // scene must not be empty
+    void (*closestHit)(const RaySceneView<T>&, const Ray3D<T>*, std::size_t, RayHit<T>*);
+    void (*anyHit)(const RaySceneView<T>&, const Ray3D<T>*, std::size_t, std::uint8_t*);
+
+    // squared distances between the query triangle and the soa triangles of a range, only the query's vertices
+    // are used
+    void (*triangleDistance)(const QueryData<T>&, const SoAView<T>&, std::size_t, std::size_t, T*);
+};
+
+    // kernels of the level chosen by setSimdLevel, instantiated for float and double
+    template <typename T>
+    const KernelTable<T>& activeKernels();
+
+#ifdef GEOMETRY_X86_SIMD
+    template <typename T>
+    const KernelTable<T>& avx2Kernels();
+    template <typename T>
+    const KernelTable<T>& avx512Kernels();
+
+    template <> const KernelTable<float>& avx2Kernels<float>();
+    template <> const KernelTable<double>& avx2Kernels<double>();
+    template <> const KernelTable<float>& avx512Kernels<float>();
+    template <> const KernelTable<double>& avx512Kernels<double>();
+#endif
+
+#ifdef GEOMETRY_KERNEL_TARGET
+#define GEOMETRY_KERNEL_PRAGMA(text) _Pragma(#text)
+#define GEOMETRY_KERNEL_TARGET_PRAGMA(name) GEOMETRY_KERNEL_PRAGMA(GCC target(name))
+#pragma GCC push_options
+GEOMETRY_KERNEL_TARGET_PRAGMA(GEOMETRY_KERNEL_TARGET)
+#endif
+
+inline namespace GEOMETRY_KERNEL_ISA
+{
+
+// A side of a plane through three vertices is the sign of a determinant (b - a) x (c - a) . (d - a). Computed
+// in T it is off by at most this much times the sum of the magnitudes of its terms: every term goes through 8
+// roundings (Shewchuk's orient3d bound), doubled for the higher order terms. Only signs beyond the bound are
+// certain, the exact test decides the rest.
+template <typename T>
+constexpr T DETERMINANT_ERROR = 8 * std::numeric_limits<T>::epsilon();
+
+template <typename Simd>
+typename Simd::mask aabbMask(const QueryData<typename Simd::value_type>& query,
+                             const SoAView<typename Simd::value_type>& soa, std::size_t idx)
+{
+    typename Simd::mask result = Simd::trueMask();
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        typename Simd::reg first = Simd::load(soa.coord[0][axis] + idx);
+        typename Simd::reg second = Simd::load(soa.coord[1][axis] + idx);
+        typename Simd::reg third = Simd::load(soa.coord[2][axis] + idx);
+
+        typename Simd::reg min = Simd::min(first, Simd::min(second, third));
+        typename Simd::reg max = Simd::max(first, Simd::max(second, third));
+
+        // the same sums as AABB3D::overlaps with the query first, with a wider slack
+        result = Simd::andMask(result, Simd::le(min, Simd::set1(query.max[axis] + query.eps)));
+        result = Simd::andMask(result, Simd::le(Simd::set1(query.min[axis]), Simd::add(max, Simd::set1(query.eps))));
+    }
+
+    return result;
+}
+
+// dist are the determinants of three vertices against a plane and bound their rounding errors
+template <typename Simd>
+typename Simd::mask notOneSide(const typename Simd::reg dist[3], const typename Simd::reg bound[3])
+{
+    typename Simd::mask above = Simd::trueMask(), below = Simd::trueMask();
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        above = Simd::andMask(above, Simd::gt(dist[vertex], bound[vertex]));
+        below = Simd::andMask(below, Simd::lt(dist[vertex], Simd::sub(Simd::set1(0), bound[vertex])));
+    }
+
+    return Simd::notMask(Simd::orMask(above, below));
+}
+
+// soa triangles' vertices against the query's plane
+template <typename Simd>
+typename Simd::mask planeSideMask(const QueryData<typename Simd::value_type>& query,
+                                  const SoAView<typename Simd::value_type>& soa, std::size_t idx)
+{
+    using T = typename Simd::value_type;
+
+    typename Simd::reg dist[3], bound[3];
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        dist[vertex] = Simd::set1(0);
+        bound[vertex] = Simd::set1(0);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            typename Simd::reg rel = Simd::sub(Simd::load(soa.coord[vertex][axis] + idx), Simd::set1(query.vertex[0][axis]));
+
+            dist[vertex] = Simd::add(dist[vertex], Simd::mul(Simd::set1(query.normal[axis]), rel));
+            bound[vertex] = Simd::add(bound[vertex], Simd::mul(Simd::set1(query.normalTerms[axis]), Simd::abs(rel)));
+        }
+
+        bound[vertex] = Simd::mul(bound[vertex], Simd::set1(DETERMINANT_ERROR<T>));
+    }
+
+    return notOneSide<Simd>(dist, bound);
+}
+
+// query's vertices against the soa triangles' planes
+template <typename Simd>
+typename Simd::mask reversePlaneSideMask(const QueryData<typename Simd::value_type>& query,
+                                         const SoAView<typename Simd::value_type>& soa, std::size_t idx)
+{
+    using T = typename Simd::value_type;
+
+    typename Simd::reg origin[3];
+    typename Simd::reg first[3];
+    typename Simd::reg second[3];
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        origin[axis] = Simd::load(soa.coord[0][axis] + idx);
+        first[axis] = Simd::sub(Simd::load(soa.coord[1][axis] + idx), origin[axis]);
+        second[axis] = Simd::sub(Simd::load(soa.coord[2][axis] + idx), origin[axis]);
+    }
+
+    typename Simd::reg norm[3], terms[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        int next = (axis + 1) % 3, last = (axis + 2) % 3;
+
+        typename Simd::reg lhs = Simd::mul(first[next], second[last]);
+        typename Simd::reg rhs = Simd::mul(first[last], second[next]);
+
+        norm[axis] = Simd::sub(lhs, rhs);
+        terms[axis] = Simd::add(Simd::abs(lhs), Simd::abs(rhs));
+    }
+
+    typename Simd::reg dist[3], bound[3];
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        dist[vertex] = Simd::set1(0);
+        bound[vertex] = Simd::set1(0);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            typename Simd::reg rel = Simd::sub(Simd::set1(query.vertex[vertex][axis]), origin[axis]);
+
+            dist[vertex] = Simd::add(dist[vertex], Simd::mul(norm[axis], rel));
+            bound[vertex] = Simd::add(bound[vertex], Simd::mul(terms[axis], Simd::abs(rel)));
+        }
+
+        bound[vertex] = Simd::mul(bound[vertex], Simd::set1(DETERMINANT_ERROR<T>));
+    }
+
+    return notOneSide<Simd>(dist, bound);
+}
+
+template <typename Simd, typename Simd::mask (*Stage)(const QueryData<typename Simd::value_type>&,
+                                                      const SoAView<typename Simd::value_type>&, std::size_t)>
+void runStage(const QueryData<typename Simd::value_type>& query, const SoAView<typename Simd::value_type>& soa,
+              std::size_t begin, std::size_t end, std::uint8_t* out)
+{
+    for (std::size_t idx = begin; idx < end; idx += Simd::WIDTH)
+    {
+        unsigned bits = Simd::bits(Stage(query, soa, idx));
+        std::size_t count = (end - idx < Simd::WIDTH) ? end - idx : Simd::WIDTH;
+
+        for (std::size_t lane = 0; lane < count; ++lane)
+            out[idx - begin + lane] = (bits >> lane) & 1u;
+    }
+}
+
+template <typename Simd>
+typename Simd::mask narrowPhaseMask(const QueryData<typename Simd::value_type>& query,
+                                    const SoAView<typename Simd::value_type>& soa, std::size_t idx)
+{
+    return Simd::andMask(aabbMask<Simd>(query, soa, idx),
+                         Simd::andMask(planeSideMask<Simd>(query, soa, idx), reversePlaneSideMask<Simd>(query, soa, idx)));
+}
+
+// Line kernels below take the batch size instead of a range, the inputs are padded like TriangleSoA's.
+// Outputs are caller-owned and exactly count long, so the last partial vector goes through a local buffer.
+
+template <typename Simd>
+void storeLanes(typename Simd::value_type* out, typename Simd::reg value, std::size_t count)
+{
+    if (count == Simd::WIDTH)
+    {
+        Simd::store(out, value);
+        return;
+    }
+
+    typename Simd::value_type lanes[Simd::WIDTH];
+    Simd::store(lanes, value);
+
+    for (std::size_t lane = 0; lane < count; ++lane)
+        out[lane] = lanes[lane];
+}
+
+template <typename Simd>
+void storeBits(std::uint8_t* out, typename Simd::mask mask, std::size_t count)
+{
+    unsigned bits = Simd::bits(mask);
+
+    for (std::size_t lane = 0; lane < count; ++lane)
+        out[lane] = (bits >> lane) & 1u;
+}
+
+template <typename Simd>
+typename Simd::reg dot(const typename Simd::reg lhs[3], const typename Simd::reg rhs[3])
+{
+    return Simd::add(Simd::mul(lhs[0], rhs[0]), Simd::add(Simd::mul(lhs[1], rhs[1]), Simd::mul(lhs[2], rhs[2])));
+}
+
+template <typename Simd>
+void cross(const typename Simd::reg lhs[3], const typename Simd::reg rhs[3], typename Simd::reg out[3])
+{
+    out[0] = Simd::sub(Simd::mul(lhs[1], rhs[2]), Simd::mul(lhs[2], rhs[1]));
+    out[1] = Simd::sub(Simd::mul(lhs[2], rhs[0]), Simd::mul(lhs[0], rhs[2]));
+    out[2] = Simd::sub(Simd::mul(lhs[0], rhs[1]), Simd::mul(lhs[1], rhs[0]));
+}
+
+// same formulas as the scalar planeLineIntersect, lines parallel to the plane are misses
+template <typename Simd>
+void planeLineKernel(const PlaneData<typename Simd::value_type>& plane, const LineView<typename Simd::value_type>& lines,
+                     std::size_t count, const PointOutput<typename Simd::value_type>& out)
+{
+    typename Simd::reg norm[3] = {Simd::set1(plane.norm[0]), Simd::set1(plane.norm[1]), Simd::set1(plane.norm[2])};
+
+    for (std::size_t idx = 0; idx < count; idx += Simd::WIDTH)
+    {
+        std::size_t lanes = (count - idx < Simd::WIDTH) ? count - idx : Simd::WIDTH;
+
+        typename Simd::reg point[3], direction[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            point[axis] = Simd::load(lines.point[axis] + idx);
+            direction[axis] = Simd::load(lines.direction[axis] + idx);
+        }
+
+        typename Simd::reg denom = dot<Simd>(norm, direction);
+        typename Simd::reg num = Simd::add(dot<Simd>(norm, point), Simd::set1(plane.d));
+        typename Simd::reg t = Simd::div(Simd::sub(Simd::set1(0), num), denom);
+
+        for (int axis = 0; axis < 3; ++axis)
+            storeLanes<Simd>(out.coord[axis] + idx, Simd::add(point[axis], Simd::mul(direction[axis], t)), lanes);
+
+        storeBits<Simd>(out.hit + idx, Simd::ge(Simd::abs(denom), Simd::set1(plane.eps)), lanes);
+    }
+}
+
+// same formulas as the scalar lineLineIntersect with the query line as the first one
+template <typename Simd>
+void lineLineKernel(const LineData<typename Simd::value_type>& query, const LineView<typename Simd::value_type>& lines,
+                    std::size_t count, const PointOutput<typename Simd::value_type>& out)
+{
+    typename Simd::reg queryPoint[3], queryDirection[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        queryPoint[axis] = Simd::set1(query.point[axis]);
+        queryDirection[axis] = Simd::set1(query.direction[axis]);
+    }
+
+    typename Simd::reg eps = Simd::set1(query.eps);
+
+    for (std::size_t idx = 0; idx < count; idx += Simd::WIDTH)
+    {
+        std::size_t lanes = (count - idx < Simd::WIDTH) ? count - idx : Simd::WIDTH;
+
+        typename Simd::reg diff[3], direction[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            diff[axis] = Simd::sub(Simd::load(lines.point[axis] + idx), queryPoint[axis]);
+            direction[axis] = Simd::load(lines.direction[axis] + idx);
+        }
+
+        typename Simd::reg normal[3], diffCross[3];
+        cross<Simd>(queryDirection, direction, normal);
+        cross<Simd>(diff, direction, diffCross);
+
+        typename Simd::mask parallel = Simd::andMask(Simd::lt(Simd::abs(normal[0]), eps),
+                                       Simd::andMask(Simd::lt(Simd::abs(normal[1]), eps), Simd::lt(Simd::abs(normal[2]), eps)));
+        typename Simd::mask coplanar = Simd::lt(Simd::abs(dot<Simd>(diff, normal)), eps);
+
+        typename Simd::reg t = Simd::div(dot<Simd>(diffCross, normal), dot<Simd>(normal, normal));
+
+        for (int axis = 0; axis < 3; ++axis)
+            storeLanes<Simd>(out.coord[axis] + idx, Simd::add(queryPoint[axis], Simd::mul(queryDirection[axis], t)), lanes);
+
+        storeBits<Simd>(out.hit + idx, Simd::andMask(Simd::notMask(parallel), coplanar), lanes);
+    }
+}
+
+template <typename Simd>
+void planePointKernel(const PlaneData<typename Simd::value_type>& plane, const PointView<typename Simd::value_type>& points,
+                      std::size_t count, std::uint8_t* hit)
+{
+    typename Simd::reg norm[3] = {Simd::set1(plane.norm[0]), Simd::set1(plane.norm[1]), Simd::set1(plane.norm[2])};
+
+    for (std::size_t idx = 0; idx < count; idx += Simd::WIDTH)
+    {
+        std::size_t lanes = (count - idx < Simd::WIDTH) ? count - idx : Simd::WIDTH;
+
+        typename Simd::reg point[3];
+        for (int axis = 0; axis < 3; ++axis)
+            point[axis] = Simd::load(points.coord[axis] + idx);
+
+        typename Simd::reg dist = Simd::add(dot<Simd>(norm, point), Simd::set1(plane.d));
+
+        storeBits<Simd>(hit + idx, Simd::lt(Simd::abs(dist), Simd::set1(plane.eps)), lanes);
+    }
+}
+
+// Ray packets: one ray per lane, every box and triangle is broadcast and tested against the whole packet.
+
+template <typename Simd>
+struct RayPacket
+{
+    typename Simd::reg origin[3];
+    typename Simd::reg direction[3];
+    typename Simd::reg invDirection[3];
+    typename Simd::reg tMin;
+    typename Simd::reg tMax;
+};
+
+// lanes past count and invalid rays get an empty interval, so they never hit anything
+template <typename Simd>
+RayPacket<Simd> loadPacket(const Ray3D<typename Simd::value_type>* rays, std::size_t count)
+{
+    using T = typename Simd::value_type;
+
+    // zero direction components would make the slab test compute 0 * inf
+    constexpr T TINY = T(1e-20);
+
+    T origin[3][Simd::WIDTH], direction[3][Simd::WIDTH], invDirection[3][Simd::WIDTH];
+    T tMin[Simd::WIDTH], tMax[Simd::WIDTH];
+
+    for (std::size_t lane = 0; lane < Simd::WIDTH; ++lane)
+    {
+        bool used = lane < count && rays[lane].valid();
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            T dir = used ? rays[lane].direction.coords[axis] : T{1};
+
+            origin[axis][lane] = used ? rays[lane].origin.coords[axis] : T{0};
+            direction[axis][lane] = dir;
+            invDirection[axis][lane] = 1 / (std::abs(dir) < TINY ? std::copysign(TINY, dir) : dir);
+        }
+
+        tMin[lane] = used ? rays[lane].tMin : T{1};
+        tMax[lane] = used ? rays[lane].tMax : T{0};
+    }
+
+    RayPacket<Simd> packet;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        packet.origin[axis] = Simd::load(origin[axis]);
+        packet.direction[axis] = Simd::load(direction[axis]);
+        packet.invDirection[axis] = Simd::load(invDirection[axis]);
+    }
+    packet.tMin = Simd::load(tMin);
+    packet.tMax = Simd::load(tMax);
+
+    return packet;
+}
+
+// slab test, tNear gets the entry distance of every lane
+template <typename Simd>
+typename Simd::mask rayBoxMask(const RayPacket<Simd>& packet, const BVHNode<typename Simd::value_type>& node,
+                               typename Simd::reg& tNear)
+{
+    typename Simd::reg near = packet.tMin, far = packet.tMax;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        typename Simd::reg t0 = Simd::mul(Simd::sub(Simd::set1(node.min[axis]), packet.origin[axis]), packet.invDirection[axis]);
+        typename Simd::reg t1 = Simd::mul(Simd::sub(Simd::set1(node.max[axis]), packet.origin[axis]), packet.invDirection[axis]);
+
+        near = Simd::max(near, Simd::min(t0, t1));
+        far = Simd::min(far, Simd::max(t0, t1));
+    }
+
+    tNear = near;
+    return Simd::le(near, far);
+}
+
+// Moller-Trumbore against the triangle at position idx of the scene
+template <typename Simd>
+typename Simd::mask rayTriangleMask(const RayPacket<Simd>& packet, const RaySceneView<typename Simd::value_type>& scene,
+                                    std::uint32_t idx, typename Simd::reg& t, typename Simd::reg& u, typename Simd::reg& v)
+{
+    typename Simd::reg edge1[3], edge2[3], tvec[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        edge1[axis] = Simd::set1(scene.edge1[axis][idx]);
+        edge2[axis] = Simd::set1(scene.edge2[axis][idx]);
+        tvec[axis] = Simd::sub(packet.origin[axis], Simd::set1(scene.vertex[axis][idx]));
+    }
+
+    typename Simd::reg pvec[3], qvec[3];
+    cross<Simd>(packet.direction, edge2, pvec);
+    cross<Simd>(tvec, edge1, qvec);
+
+    typename Simd::reg det = dot<Simd>(edge1, pvec);
+    typename Simd::reg invDet = Simd::div(Simd::set1(1), det);
+
+    u = Simd::mul(dot<Simd>(tvec, pvec), invDet);
+    v = Simd::mul(dot<Simd>(packet.direction, qvec), invDet);
+    t = Simd::mul(dot<Simd>(edge2, qvec), invDet);
+
+    typename Simd::reg zero = Simd::set1(0);
+
+    typename Simd::mask inside = Simd::andMask(Simd::andMask(Simd::ge(u, zero), Simd::ge(v, zero)),
+                                               Simd::le(Simd::add(u, v), Simd::set1(1)));
+    typename Simd::mask inRange = Simd::andMask(Simd::ge(t, packet.tMin), Simd::lt(t, packet.tMax));
+
+    return Simd::andMask(Simd::gt(Simd::abs(det), zero), Simd::andMask(inside, inRange));
+}
+
+// Depth-first descent while a lane's interval reaches the box. visit(idx) is called for every triangle of the
+// reached leaves and may shrink packet.tMax; traversal stops when it returns true.
+template <typename Simd, typename Visit>
+void traversePacket(const RaySceneView<typename Simd::value_type>& scene, RayPacket<Simd>& packet, Visit visit)
+{
+    using T = typename Simd::value_type;
+
+    std::uint32_t stack[2 * BVH<T>::MAX_DEPTH];
+    std::size_t size = 0;
+
+    typename Simd::reg leftNear, rightNear;
+    if (Simd::bits(rayBoxMask<Simd>(packet, scene.nodes[0], leftNear)))
+        stack[size++] = 0;
+
+    while (size)
+    {
+        const BVHNode<T>& node = scene.nodes[stack[--size]];
+
+        if (node.leaf())
+        {
+            for (std::uint32_t idx = node.first; idx < node.first + node.count; ++idx)
+                if (visit(idx))
+                    return;
+
+            continue;
+        }
+
+        unsigned left = Simd::bits(rayBoxMask<Simd>(packet, scene.nodes[node.first], leftNear));
+        unsigned right = Simd::bits(rayBoxMask<Simd>(packet, scene.nodes[node.first + 1], rightNear));
+
+        if (left && right)
+        {
+            // the child nearer for most of the lanes is visited first
+            unsigned both = left & right;
+            unsigned leftFirst = Simd::bits(Simd::le(leftNear, rightNear)) & both;
+            bool leftNearer = 2 * std::popcount(leftFirst) >= std::popcount(both);
+
+            stack[size++] = leftNearer ? node.first + 1 : node.first;
+            stack[size++] = leftNearer ? node.first : node.first + 1;
+        }
+        else if (left)
+            stack[size++] = node.first;
+        else if (right)
+            stack[size++] = node.first + 1;
+    }
+}
+
+template <typename Simd>
+void closestHitKernel(const RaySceneView<typename Simd::value_type>& scene, const Ray3D<typename Simd::value_type>* rays,
+                      std::size_t count, RayHit<typename Simd::value_type>* out)
+{
+    using T = typename Simd::value_type;
+
+    for (std::size_t first = 0; first < count; first += Simd::WIDTH)
+    {
+        std::size_t lanes = (count - first < Simd::WIDTH) ? count - first : Simd::WIDTH;
+        RayPacket<Simd> packet = loadPacket<Simd>(rays + first, lanes);
+
+        typename Simd::reg hitU = Simd::set1(0), hitV = Simd::set1(0);
+        std::uint32_t hitTriangle[Simd::WIDTH] = {};
+        unsigned hitLanes = 0;
+
+        traversePacket<Simd>(scene, packet, [&](std::uint32_t idx)
+        {
+            typename Simd::reg t, u, v;
+            typename Simd::mask hit = rayTriangleMask<Simd>(packet, scene, idx, t, u, v);
+
+            unsigned bits = Simd::bits(hit);
+            if (!bits)
+                return false;
+
+            packet.tMax = Simd::select(hit, t, packet.tMax);
+            hitU = Simd::select(hit, u, hitU);
+            hitV = Simd::select(hit, v, hitV);
+
+            hitLanes |= bits;
+            for (; bits; bits &= bits - 1)
+                hitTriangle[std::countr_zero(bits)] = idx;
+
+            return false;
+        });
+
+        T t[Simd::WIDTH], u[Simd::WIDTH], v[Simd::WIDTH];
+        Simd::store(t, packet.tMax);
+        Simd::store(u, hitU);
+        Simd::store(v, hitV);
+
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+            out[first + lane] = ((hitLanes >> lane) & 1u) ? RayHit<T>{t[lane], u[lane], v[lane], scene.ids[hitTriangle[lane]]}
+                                                          : RayHit<T>{};
+    }
+}
+
+template <typename Simd>
+void anyHitKernel(const RaySceneView<typename Simd::value_type>& scene, const Ray3D<typename Simd::value_type>* rays,
+                  std::size_t count, std::uint8_t* out)
+{
+    using T = typename Simd::value_type;
+
+    for (std::size_t first = 0; first < count; first += Simd::WIDTH)
+    {
+        std::size_t lanes = (count - first < Simd::WIDTH) ? count - first : Simd::WIDTH;
+        RayPacket<Simd> packet = loadPacket<Simd>(rays + first, lanes);
+
+        unsigned hitLanes = 0;
+
+        traversePacket<Simd>(scene, packet, [&](std::uint32_t idx)
+        {
+            typename Simd::reg t, u, v;
+            typename Simd::mask hit = rayTriangleMask<Simd>(packet, scene, idx, t, u, v);
+
+            unsigned bits = Simd::bits(hit);
+            if (!bits)
+                return false;
+
+            // lanes with a hit are done: their empty interval keeps them out of the remaining boxes
+            hitLanes |= bits;
+            packet.tMax = Simd::select(hit, Simd::set1(-inf<T>), packet.tMax);
+
+            return Simd::bits(Simd::le(packet.tMin, packet.tMax)) == 0;
+        });
+
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+            out[first + lane] = (hitLanes >> lane) & 1u;
+    }
+}
+
+// Triangle distances: the smallest of the distances between the edges, the distances of the vertices to the
+// other triangle's face where they project into it, and zero where an edge crosses the other triangle's face.
+// Degenerate triangles have no face, their edges cover them.
+
+template <typename Simd>
+typename Simd::reg clampUnit(typename Simd::reg value)
+{
+    return Simd::min(Simd::max(value, Simd::set1(0)), Simd::set1(1));
+}
+
+// closest points p1 + d1 * s and p2 + d2 * t as in Ericson's Real-Time Collision Detection, 5.1.9,
+// with every branch computed and selected per lane
+template <typename Simd>
+typename Simd::reg segmentDistanceSq(const typename Simd::reg p1[3], const typename Simd::reg q1[3],
+                                     const typename Simd::reg p2[3], const typename Simd::reg q2[3])
+{
+    typename Simd::reg zero = Simd::set1(0), one = Simd::set1(1);
+
+    typename Simd::reg d1[3], d2[3], r[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        d1[axis] = Simd::sub(q1[axis], p1[axis]);
+        d2[axis] = Simd::sub(q2[axis], p2[axis]);
+        r[axis] = Simd::sub(p1[axis], p2[axis]);
+    }
+
+    typename Simd::reg a = dot<Simd>(d1, d1), e = dot<Simd>(d2, d2), b = dot<Simd>(d1, d2);
+    typename Simd::reg c = dot<Simd>(d1, r), f = dot<Simd>(d2, r);
+
+    typename Simd::mask firstPoint = Simd::notMask(Simd::gt(a, zero));
+    typename Simd::mask secondPoint = Simd::notMask(Simd::gt(e, zero));
+    typename Simd::reg safeA = Simd::select(firstPoint, one, a);
+    typename Simd::reg safeE = Simd::select(secondPoint, one, e);
+
+    // parallel segments start at s = 0
+    typename Simd::reg denom = Simd::sub(Simd::mul(a, e), Simd::mul(b, b));
+    typename Simd::mask skew = Simd::gt(denom, zero);
+    typename Simd::reg s = Simd::select(skew, clampUnit<Simd>(Simd::div(Simd::sub(Simd::mul(b, f), Simd::mul(c, e)),
+                                                                        Simd::select(skew, denom, one))), zero);
+
+    // t outside [0, 1] is clamped and s recomputed for it
+    typename Simd::reg t = Simd::div(Simd::add(Simd::mul(b, s), f), safeE);
+    typename Simd::mask outside = Simd::orMask(Simd::lt(t, zero), Simd::gt(t, one));
+    t = clampUnit<Simd>(t);
+    s = Simd::select(outside, clampUnit<Simd>(Simd::div(Simd::sub(Simd::mul(b, t), c), safeA)), s);
+
+    s = Simd::select(firstPoint, zero, s);
+    t = Simd::select(firstPoint, clampUnit<Simd>(Simd::div(f, safeE)), t);
+    s = Simd::select(secondPoint, clampUnit<Simd>(Simd::div(Simd::sub(zero, c), safeA)), s);
+    t = Simd::select(secondPoint, zero, t);
+
+    typename Simd::reg diff[3];
+    for (int axis = 0; axis < 3; ++axis)
+        diff[axis] = Simd::sub(Simd::add(r[axis], Simd::mul(d1[axis], s)), Simd::mul(d2[axis], t));
+
+    return dot<Simd>(diff, diff);
+}
+
+// point lies in the face's plane; points on the boundary are inside
+template <typename Simd>
+typename Simd::mask insideFace(const typename Simd::reg face[3][3], const typename Simd::reg norm[3],
+                               const typename Simd::reg point[3])
+{
+    typename Simd::mask result = Simd::trueMask();
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        const typename Simd::reg* next = face[(vertex + 1) % 3];
+
+        typename Simd::reg edge[3], rel[3], side[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            edge[axis] = Simd::sub(next[axis], face[vertex][axis]);
+            rel[axis] = Simd::sub(point[axis], face[vertex][axis]);
+        }
+
+        cross<Simd>(edge, rel, side);
+        result = Simd::andMask(result, Simd::ge(dot<Simd>(side, norm), Simd::set1(0)));
+    }
+
+    return result;
+}
+
+// squared distances of other's vertices projecting into face and zero for other's edges crossing it,
+// infinity where there are none
+template <typename Simd>
+typename Simd::reg faceDistanceSq(const typename Simd::reg face[3][3], const typename Simd::reg other[3][3])
+{
+    using T = typename Simd::value_type;
+
+    typename Simd::reg zero = Simd::set1(0), one = Simd::set1(1);
+
+    typename Simd::reg first[3], second[3], norm[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        first[axis] = Simd::sub(face[1][axis], face[0][axis]);
+        second[axis] = Simd::sub(face[2][axis], face[0][axis]);
+    }
+    cross<Simd>(first, second, norm);
+
+    typename Simd::reg normSq = dot<Simd>(norm, norm);
+    typename Simd::mask hasFace = Simd::gt(normSq, zero);
+    typename Simd::reg safeNormSq = Simd::select(hasFace, normSq, one);
+
+    // signed distances scaled by the normal's length
+    typename Simd::reg dist[3];
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        typename Simd::reg rel[3];
+        for (int axis = 0; axis < 3; ++axis)
+            rel[axis] = Simd::sub(other[vertex][axis], face[0][axis]);
+
+        dist[vertex] = dot<Simd>(norm, rel);
+    }
+
+    typename Simd::reg best = Simd::set1(inf<T>);
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        typename Simd::reg scale = Simd::div(dist[vertex], safeNormSq);
+
+        typename Simd::reg projected[3];
+        for (int axis = 0; axis < 3; ++axis)
+            projected[axis] = Simd::sub(other[vertex][axis], Simd::mul(norm[axis], scale));
+
+        typename Simd::mask inside = Simd::andMask(hasFace, insideFace<Simd>(face, norm, projected));
+        best = Simd::select(inside, Simd::min(best, Simd::mul(dist[vertex], scale)), best);
+    }
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        int next = (vertex + 1) % 3;
+
+        typename Simd::mask opposite = Simd::orMask(Simd::andMask(Simd::le(dist[vertex], zero), Simd::ge(dist[next], zero)),
+                                                    Simd::andMask(Simd::ge(dist[vertex], zero), Simd::le(dist[next], zero)));
+        typename Simd::reg diff = Simd::sub(dist[vertex], dist[next]);
+        typename Simd::mask crossing = Simd::andMask(opposite, Simd::gt(Simd::abs(diff), zero));
+
+        typename Simd::reg t = Simd::div(dist[vertex], Simd::select(crossing, diff, one));
+
+        typename Simd::reg point[3];
+        for (int axis = 0; axis < 3; ++axis)
+            point[axis] = Simd::add(other[vertex][axis], Simd::mul(Simd::sub(other[next][axis], other[vertex][axis]), t));
+
+        typename Simd::mask inside = Simd::andMask(Simd::andMask(hasFace, crossing), insideFace<Simd>(face, norm, point));
+        best = Simd::select(inside, zero, best);
+    }
+
+    return best;
+}
+
+template <typename Simd>
+void triangleDistanceKernel(const QueryData<typename Simd::value_type>& query, const SoAView<typename Simd::value_type>& soa,
+                            std::size_t begin, std::size_t end, typename Simd::value_type* out)
+{
+    typename Simd::reg queryVertex[3][3];
+    for (int vertex = 0; vertex < 3; ++vertex)
+        for (int axis = 0; axis < 3; ++axis)
+            queryVertex[vertex][axis] = Simd::set1(query.vertex[vertex][axis]);
+
+    for (std::size_t idx = begin; idx < end; idx += Simd::WIDTH)
+    {
+        std::size_t lanes = (end - idx < Simd::WIDTH) ? end - idx : Simd::WIDTH;
+
+        typename Simd::reg triangle[3][3];
+        for (int vertex = 0; vertex < 3; ++vertex)
+            for (int axis = 0; axis < 3; ++axis)
+                triangle[vertex][axis] = Simd::load(soa.coord[vertex][axis] + idx);
+
+        typename Simd::reg best = Simd::min(faceDistanceSq<Simd>(queryVertex, triangle),
+                                            faceDistanceSq<Simd>(triangle, queryVertex));
+
+        for (int lhs = 0; lhs < 3; ++lhs)
+            for (int rhs = 0; rhs < 3; ++rhs)
+                best = Simd::min(best, segmentDistanceSq<Simd>(queryVertex[lhs], queryVertex[(lhs + 1) % 3],
+                                                               triangle[rhs], triangle[(rhs + 1) % 3]));
+
+        storeLanes<Simd>(out + idx - begin, best, lanes);
+    }
+}
+
+template <typename Simd>
+KernelTable<typename Simd::value_type> makeKernelTable()
+{
+    return KernelTable<typename Simd::value_type>
+    {
+        runStage<Simd, aabbMask<Simd>>,
+        runStage<Simd, planeSideMask<Simd>>,
+        runStage<Simd, narrowPhaseMask<Simd>>,
+        planeLineKernel<Simd>,
+        lineLineKernel<Simd>,
+        planePointKernel<Simd>,
+        closestHitKernel<Simd>,
+        anyHitKernel<Simd>,
+        triangleDistanceKernel<Simd>
+    };
+}
+
+}
+
+#ifdef GEOMETRY_KERNEL_TARGET
+#pragma GCC pop_options
+#endif
+
+}
+
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef TILED_INTERSECTION_HH
+#define TILED_INTERSECTION_HH
+
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "geometry3D.hh"
+
+
+// Intersection of triangle soups larger than the memory available. The input is split into spatial tiles kept
+// in a scratch file, and only the tiles whose bounds overlap are brought into memory together, so the memory in
+// use stays within a budget however large the input is.
+namespace geometry3D
+{
+
+struct TilingOptions
+{
+    // bytes of triangles, search structures and buffers held in memory at once
+    std::size_t memoryBudget = std::size_t{1} << 30;
+    // where the scratch files go, the system temporary directory if empty; they are deleted on return
+    std::string scratchDirectory;
+};
+
+// Marks the triangles of a file intersecting at least one other triangle, read as loadStl reads it if the name
+// ends with .stl and as loadTriangles otherwise. The result has one element per input triangle rather than
+// a list of indices, which could outgrow the budget itself.
+//
+// Every triangle belongs to the one tile its centroid falls into; a tile's bounds cover its triangles whole,
+// so triangles spanning a boundary make the bounds of neighbouring tiles overlap. Each pair of overlapping tiles
+// is tested once, which tests every pair of triangles at most once and needs no deduplication. Tiles are formed
+// from cells of a fine grid in Morton order, so skewed inputs still give tiles of about equal size; only a
+// single cell holding more triangles than the budget allows gives a larger tile.
+//
+// Triangles with invalid vertices intersect nothing. Errors are reported as by the loaders, failures of the
+// scratch file with std::system_error. Instantiated for float and double.
+template <typename T>
+std::vector<bool> intersectingTrianglesOutOfCore(const std::string& path, const TilingOptions& options = {});
+
+}
+
+
+#endif
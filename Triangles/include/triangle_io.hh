@@ -0,0 +1,120 @@
+#ifndef TRIANGLE_IO_HH
+#define TRIANGLE_IO_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "geometry3D.hh"
+#include "triangle_soa.hh"
+
+
+// Input of triangle soups. The text format is the one main reads: the number of triangles N followed by
+// 9 * N coordinates, x y z of every vertex of every triangle, separated by any whitespace.
+// Malformed input is reported with std::runtime_error, failures to open or map a file with std::system_error.
+namespace geometry3D
+{
+
+// Read-only memory mapping of a whole file, empty files map to an empty view.
+class MappedFile
+{
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+public:
+
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator= (MappedFile&& other) noexcept;
+
+    ~MappedFile();
+
+    std::string_view view() const { return std::string_view{data_, size_}; }
+
+    // Gives the whole pages of bytes [offset, offset + size) back to the system, they are read from the file
+    // again if accessed later. Lets files larger than memory be streamed through the mapping.
+    void release(std::size_t offset, std::size_t size) const;
+};
+
+// Parses the text format into a TriangleSoA. The coordinates are split into chunks at whitespace, the chunks
+// are parsed by separate threads with std::from_chars and written in place; chunks = 0 picks the number of
+// hardware threads, fewer for small inputs. Instantiated for float and double.
+template <typename T>
+TriangleSoA<T> parseTriangles(std::string_view text, std::size_t chunks = 0);
+
+template <typename T>
+TriangleSoA<T> loadTriangles(const std::string& path, std::size_t chunks = 0);
+
+// Sequential parser of the text format for inputs too large to be held as a TriangleSoA: triangles are read one
+// at a time and only the position in the text is kept. Errors are reported as by parseTriangles, coordinates
+// missing or left over when the end is reached. Instantiated for float and double.
+template <typename T>
+class TriangleTextReader
+{
+    std::string_view text_;
+    const char* pos_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t read_ = 0;
+
+public:
+
+    explicit TriangleTextReader(std::string_view text);
+
+    // number of triangles the text declares
+    std::size_t size() const { return size_; }
+
+    // bytes of the text parsed so far
+    std::size_t offset() const { return static_cast<std::size_t>(pos_ - text_.data()); }
+
+    // returns false once all triangles are read
+    bool next(Triangle3D<T>& tr);
+};
+
+// View of binary STL data: an 80 byte header, a 32-bit triangle count and 50 byte records of a normal, three
+// vertices as little-endian 32-bit floats and a 16-bit attribute. Vertices are read straight from the bytes,
+// which the view does not own; only little-endian hosts are supported.
+class StlView
+{
+    const char* records_ = nullptr;
+    std::size_t size_ = 0;
+
+public:
+
+    static constexpr std::size_t HEADER_SIZE = 84;
+    static constexpr std::size_t RECORD_SIZE = 50;
+
+    explicit StlView(std::string_view bytes);
+
+    std::size_t size() const { return size_; }
+
+    Triangle3D<float> operator[](std::size_t idx) const
+    {
+        return Triangle3D<float>{point(idx, 0), point(idx, 1), point(idx, 2)};
+    }
+
+    Point3D<float> point(std::size_t idx, int vertex) const
+    {
+        // the record's normal comes first and is skipped
+        float coords[3];
+        std::memcpy(coords, records_ + idx * RECORD_SIZE + (vertex + 1) * sizeof(coords), sizeof(coords));
+
+        return Point3D<float>{coords[X], coords[Y], coords[Z]};
+    }
+};
+
+// Copies the vertices of a binary STL file into a TriangleSoA, chunks as in parseTriangles.
+// Instantiated for float and double.
+template <typename T>
+TriangleSoA<T> loadStl(const std::string& path, std::size_t chunks = 0);
+
+}
+
+
+#endif
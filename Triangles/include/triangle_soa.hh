@@ -0,0 +1,160 @@
+#ifndef TRIANGLE_SOA_HH
+#define TRIANGLE_SOA_HH
+
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry3D.hh"
+
+
+namespace geometry3D
+{
+
+    enum class SimdLevel
+    {
+        Scalar,
+        AVX2,
+        AVX512
+    };
+
+    // widest instruction set supported both by the build and the running cpu
+    SimdLevel detectSimdLevel();
+
+    SimdLevel activeSimdLevel();
+    // returns false and leaves the active level unchanged if the level is not supported
+    bool setSimdLevel(SimdLevel level);
+
+// Triangles stored as 9 component arrays: coordinate c of vertex v of triangle i is coord(v, c)[i].
+// Every array is followed by SIMD_PADDING spare elements so batched kernels may load whole vectors past the end.
+template <typename T>
+class TriangleSoA
+{
+    std::vector<T> coords_[3][3];
+    std::size_t size_ = 0;
+
+public:
+
+    static constexpr std::size_t SIMD_PADDING = 16;
+
+    TriangleSoA()
+    {
+        allocate(0);
+    }
+
+    std::size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    void reserve(std::size_t capacity)
+    {
+        for (auto& vertex : coords_)
+            for (auto& component : vertex)
+                component.reserve(capacity + SIMD_PADDING);
+    }
+
+    void clear()
+    {
+        resize(0);
+    }
+
+    // added triangles have all coordinates 0, they are meant to be filled through coord()
+    void resize(std::size_t size)
+    {
+        size_ = size;
+        allocate(size);
+    }
+
+    void push_back(const Triangle3D<T>& tr)
+    {
+        allocate(size_ + 1);
+
+        for (int vertex = 0; vertex < 3; ++vertex)
+            for (int coord = 0; coord < 3; ++coord)
+                coords_[vertex][coord][size_] = tr[vertex].coords[coord];
+
+        size_++;
+    }
+
+    Triangle3D<T> operator[](std::size_t idx) const
+    {
+        return Triangle3D<T>{point(idx, 0), point(idx, 1), point(idx, 2)};
+    }
+
+    Point3D<T> point(std::size_t idx, int vertex) const
+    {
+        return Point3D<T>{coords_[vertex][X][idx], coords_[vertex][Y][idx], coords_[vertex][Z][idx]};
+    }
+
+    const T* coord(int vertex, Axis axis) const
+    {
+        return coords_[vertex][axis].data();
+    }
+
+    T* coord(int vertex, Axis axis)
+    {
+        return coords_[vertex][axis].data();
+    }
+
+private:
+
+    void allocate(std::size_t size)
+    {
+        for (auto& vertex : coords_)
+            for (auto& component : vertex)
+                component.resize(size + SIMD_PADDING, T{0});
+    }
+};
+
+// Batched tests of one query triangle against soa triangles [begin, end), instantiated for float and double.
+// Every function writes one byte per tested triangle to out[i - begin]: 1 if the triangle passed, 0 if rejected.
+
+// bounding boxes overlap
+template <typename T>
+void aabbOverlap(const Triangle3D<T>& query, const TriangleSoA<T>& soa, std::size_t begin, std::size_t end,
+                 std::uint8_t* out);
+// triangle is not strictly on one side of the query's plane
+template <typename T>
+void planeSideTest(const Triangle3D<T>& query, const TriangleSoA<T>& soa, std::size_t begin, std::size_t end,
+                   std::uint8_t* out);
+// triangles intersect: vectorized rejection stages followed by triangleTriangleIntersect on the survivors
+template <typename T>
+void triangleBatchIntersect(const Triangle3D<T>& query, const TriangleSoA<T>& soa, std::size_t begin, std::size_t end,
+                            std::uint8_t* out);
+
+// indices of triangles intersecting at least one other triangle, ascending
+template <typename T>
+std::vector<std::size_t> intersectingTriangles(const TriangleSoA<T>& soa);
+
+// Where intersectingTriangles spends its work, counted over all pairs of distinct triangles.
+struct PipelineStats
+{
+    std::uint64_t pairs = 0;
+    // broad phase: pairs whose boxes overlap
+    std::uint64_t candidates = 0;
+    // candidates passing the narrow phase filters: the second triangle is not strictly on one side of the
+    // first one's plane, and then the first one is not on one side of the second one's plane
+    std::uint64_t planeSidePassed = 0;
+    std::uint64_t reversePlaneSidePassed = 0;
+    // filter survivors decided by every stage of the exact test, indexed by TriangleTestStage
+    std::array<std::uint64_t, 6> exactDecided{};
+    std::uint64_t intersectingPairs = 0;
+
+    // the box kernel, the fused filter kernel and the exact tests
+    std::chrono::nanoseconds broadPhaseTime{0};
+    std::chrono::nanoseconds narrowPhaseTime{0};
+    std::chrono::nanoseconds exactTime{0};
+};
+
+// The same result with stats added to. Every stage runs as a separate pass to be counted and timed, so this is
+// slower than the version without stats.
+template <typename T>
+std::vector<std::size_t> intersectingTriangles(const TriangleSoA<T>& soa, PipelineStats& stats);
+
+}
+
+
+#endif
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <numeric>
+
+#include "bvh.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+constexpr int BINS = 12;
+
+template <typename T>
+struct Bounds
+{
+    T min[3] = {inf<T>, inf<T>, inf<T>};
+    T max[3] = {-inf<T>, -inf<T>, -inf<T>};
+
+    void grow(const T* lower, const T* upper)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            min[axis] = std::min(min[axis], lower[axis]);
+            max[axis] = std::max(max[axis], upper[axis]);
+        }
+    }
+
+    void grow(const Bounds& other)
+    {
+        grow(other.min, other.max);
+    }
+
+    // half of the surface area, empty bounds have none
+    T area() const
+    {
+        T x = max[X] - min[X], y = max[Y] - min[Y], z = max[Z] - min[Z];
+        return (x < 0) ? T{0} : x * y + y * z + z * x;
+    }
+};
+
+}
+
+template <typename T>
+void BVH<T>::build(std::span<const AABB3D<T>> boxes)
+{
+    nodes_.clear();
+    order_.resize(boxes.size());
+    std::iota(order_.begin(), order_.end(), 0);
+
+    if (boxes.empty())
+        return;
+
+    std::vector<T> centroids(3 * boxes.size());
+    for (std::size_t idx = 0; idx < boxes.size(); ++idx)
+        for (int axis = 0; axis < 3; ++axis)
+            centroids[3 * idx + axis] = (boxes[idx].min.coords[axis] + boxes[idx].max.coords[axis]) / 2;
+
+    nodes_.reserve(2 * boxes.size());
+    nodes_.push_back(BVHNode<T>{{}, {}, 0, static_cast<std::uint32_t>(boxes.size())});
+
+    subdivide(0, boxes, centroids, 1);
+}
+
+// Splits the node's range at the cheapest of the bin boundaries along the axis where the centroids spread most.
+// A range stays a leaf when splitting is not cheaper than testing all of it, unless it is too big for a leaf.
+template <typename T>
+void BVH<T>::subdivide(std::uint32_t nodeIdx, std::span<const AABB3D<T>> boxes, std::span<const T> centroids,
+                       std::size_t depth)
+{
+    std::uint32_t first = nodes_[nodeIdx].first;
+    std::uint32_t count = nodes_[nodeIdx].count;
+
+    Bounds<T> bounds, centroidBounds;
+    for (std::uint32_t idx = first; idx < first + count; ++idx)
+    {
+        const AABB3D<T>& box = boxes[order_[idx]];
+        bounds.grow(box.min.coords.data(), box.max.coords.data());
+
+        const T* centroid = &centroids[3 * order_[idx]];
+        centroidBounds.grow(centroid, centroid);
+    }
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        nodes_[nodeIdx].min[axis] = bounds.min[axis];
+        nodes_[nodeIdx].max[axis] = bounds.max[axis];
+    }
+
+    if (count <= LEAF_SIZE || depth + 1 >= MAX_DEPTH)
+        return;
+
+    int axis = X;
+    for (int other = Y; other <= Z; ++other)
+        if (centroidBounds.max[other] - centroidBounds.min[other] > centroidBounds.max[axis] - centroidBounds.min[axis])
+            axis = other;
+
+    T lower = centroidBounds.min[axis];
+    T extent = centroidBounds.max[axis] - lower;
+
+    // all centroids coincide, no split separates them
+    if (!(extent > 0))
+        return;
+
+    auto binOf = [&](std::uint32_t primitive)
+    {
+        int bin = static_cast<int>((centroids[3 * primitive + axis] - lower) / extent * BINS);
+        return std::clamp(bin, 0, BINS - 1);
+    };
+
+    Bounds<T> binBounds[BINS];
+    std::uint32_t binCount[BINS] = {};
+
+    for (std::uint32_t idx = first; idx < first + count; ++idx)
+    {
+        int bin = binOf(order_[idx]);
+        const AABB3D<T>& box = boxes[order_[idx]];
+
+        binBounds[bin].grow(box.min.coords.data(), box.max.coords.data());
+        binCount[bin]++;
+    }
+
+    // cost of splitting after bin i, swept from the right and then from the left
+    T rightCost[BINS - 1];
+    Bounds<T> right;
+    std::uint32_t rightCount = 0;
+    for (int bin = BINS - 1; bin > 0; --bin)
+    {
+        right.grow(binBounds[bin]);
+        rightCount += binCount[bin];
+        rightCost[bin - 1] = right.area() * rightCount;
+    }
+
+    int bestSplit = -1;
+    T bestCost = bounds.area() * count;
+    Bounds<T> left;
+    std::uint32_t leftCount = 0;
+    for (int bin = 0; bin < BINS - 1; ++bin)
+    {
+        left.grow(binBounds[bin]);
+        leftCount += binCount[bin];
+
+        T cost = left.area() * leftCount + rightCost[bin];
+        if (leftCount != 0 && leftCount != count && cost < bestCost)
+        {
+            bestCost = cost;
+            bestSplit = bin;
+        }
+    }
+
+    if (bestSplit < 0)
+    {
+        if (count <= 4 * LEAF_SIZE)
+            return;
+
+        // splitting does not pay off but the leaf would be too big: split at the median
+        std::uint32_t* begin = order_.data() + first;
+        std::nth_element(begin, begin + count / 2, begin + count, [&](std::uint32_t lhs, std::uint32_t rhs)
+        {
+            return centroids[3 * lhs + axis] < centroids[3 * rhs + axis];
+        });
+        leftCount = count / 2;
+    }
+    else
+    {
+        auto middle = std::partition(order_.begin() + first, order_.begin() + first + count, [&](std::uint32_t primitive)
+        {
+            return binOf(primitive) <= bestSplit;
+        });
+        leftCount = static_cast<std::uint32_t>(middle - order_.begin()) - first;
+    }
+
+    std::uint32_t leftIdx = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.push_back(BVHNode<T>{{}, {}, first, leftCount});
+    nodes_.push_back(BVHNode<T>{{}, {}, first + leftCount, count - leftCount});
+
+    nodes_[nodeIdx].first = leftIdx;
+    nodes_[nodeIdx].count = 0;
+
+    subdivide(leftIdx, boxes, centroids, depth + 1);
+    subdivide(leftIdx + 1, boxes, centroids, depth + 1);
+}
+
+template class BVH<float>;
+template class BVH<double>;
+
+}
@@ -0,0 +1,460 @@
+#include <algorithm>
+#include <cmath>
+
+#include "distance_query.hh"
+#include "soa_kernels.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+// ranges of up to this many triangles go through the kernel at once instead of being descended into
+constexpr std::uint32_t KERNEL_RANGE = 8;
+
+template <typename T>
+T dot(const T* lhs, const T* rhs)
+{
+    return lhs[X] * rhs[X] + lhs[Y] * rhs[Y] + lhs[Z] * rhs[Z];
+}
+
+template <typename T>
+void cross(const T* lhs, const T* rhs, T* out)
+{
+    out[X] = lhs[Y] * rhs[Z] - lhs[Z] * rhs[Y];
+    out[Y] = lhs[Z] * rhs[X] - lhs[X] * rhs[Z];
+    out[Z] = lhs[X] * rhs[Y] - lhs[Y] * rhs[X];
+}
+
+template <typename T>
+T clampUnit(T value)
+{
+    return std::clamp(value, T{0}, T{1});
+}
+
+template <typename T>
+DistanceResult<T> between(const T* first, const T* second)
+{
+    T diff[3] = {first[X] - second[X], first[Y] - second[Y], first[Z] - second[Z]};
+
+    return DistanceResult<T>{std::sqrt(dot(diff, diff)), Point3D<T>{first[X], first[Y], first[Z]},
+                             Point3D<T>{second[X], second[Y], second[Z]}};
+}
+
+// the same formulas as the kernel's segmentDistanceSq, so that the kernels and the witnesses agree
+template <typename T>
+DistanceResult<T> closestOnSegments(const T* p1, const T* q1, const T* p2, const T* q2)
+{
+    T d1[3], d2[3], r[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        d1[axis] = q1[axis] - p1[axis];
+        d2[axis] = q2[axis] - p2[axis];
+        r[axis] = p1[axis] - p2[axis];
+    }
+
+    T a = dot(d1, d1), e = dot(d2, d2), b = dot(d1, d2), c = dot(d1, r), f = dot(d2, r);
+    T s = 0, t = 0;
+
+    if (!(a > 0) && !(e > 0))
+    {}
+    else if (!(a > 0))
+        t = clampUnit(f / e);
+    else if (!(e > 0))
+        s = clampUnit(-c / a);
+    else
+    {
+        // parallel segments start at s = 0
+        T denom = a * e - b * b;
+        s = (denom > 0) ? clampUnit((b * f - c * e) / denom) : T{0};
+
+        t = (b * s + f) / e;
+        if (t < 0 || t > 1)
+        {
+            t = clampUnit(t);
+            s = clampUnit((b * t - c) / a);
+        }
+    }
+
+    T first[3], second[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        first[axis] = p1[axis] + d1[axis] * s;
+        second[axis] = p2[axis] + d2[axis] * t;
+    }
+
+    return between(first, second);
+}
+
+// point lies in the face's plane; points on the boundary are inside
+template <typename T>
+bool insideFace(const T* const face[3], const T* norm, const T* point)
+{
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        const T* next = face[(vertex + 1) % 3];
+
+        T edge[3], rel[3], side[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            edge[axis] = next[axis] - face[vertex][axis];
+            rel[axis] = point[axis] - face[vertex][axis];
+        }
+
+        cross(edge, rel, side);
+        if (!(dot(side, norm) >= 0))
+            return false;
+    }
+
+    return true;
+}
+
+// visit(onFace, onOther) for other's vertices projecting into face and for other's edges crossing it,
+// the same cases as the kernel's faceDistanceSq
+template <typename T, typename Visit>
+void faceCandidates(const T* const face[3], const T* const other[3], Visit visit)
+{
+    T first[3], second[3], norm[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        first[axis] = face[1][axis] - face[0][axis];
+        second[axis] = face[2][axis] - face[0][axis];
+    }
+    cross(first, second, norm);
+
+    T normSq = dot(norm, norm);
+    if (!(normSq > 0))
+        return;
+
+    // signed distances scaled by the normal's length
+    T dist[3];
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        T rel[3];
+        for (int axis = 0; axis < 3; ++axis)
+            rel[axis] = other[vertex][axis] - face[0][axis];
+
+        dist[vertex] = dot(norm, rel);
+    }
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        T scale = dist[vertex] / normSq;
+
+        T projected[3];
+        for (int axis = 0; axis < 3; ++axis)
+            projected[axis] = other[vertex][axis] - norm[axis] * scale;
+
+        if (insideFace(face, norm, projected))
+            visit(projected, other[vertex]);
+    }
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+    {
+        int next = (vertex + 1) % 3;
+
+        bool opposite = (dist[vertex] <= 0 && dist[next] >= 0) || (dist[vertex] >= 0 && dist[next] <= 0);
+        T diff = dist[vertex] - dist[next];
+
+        if (!opposite || !(std::abs(diff) > 0))
+            continue;
+
+        T t = dist[vertex] / diff;
+
+        T point[3];
+        for (int axis = 0; axis < 3; ++axis)
+            point[axis] = other[vertex][axis] + (other[next][axis] - other[vertex][axis]) * t;
+
+        if (insideFace(face, norm, point))
+            visit(point, point);
+    }
+}
+
+template <typename T>
+T boxDistanceSq(const BVHNode<T>& lhs, const BVHNode<T>& rhs)
+{
+    T sum = 0;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        T gap = std::max({T{0}, lhs.min[axis] - rhs.max[axis], rhs.min[axis] - lhs.max[axis]});
+        sum += gap * gap;
+    }
+
+    return sum;
+}
+
+template <typename T>
+kernels::SoAView<T> makeView(const TriangleSoA<T>& soa)
+{
+    kernels::SoAView<T> view;
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+        for (int axis = 0; axis < 3; ++axis)
+            view.coord[vertex][axis] = soa.coord(vertex, static_cast<Axis>(axis));
+
+    return view;
+}
+
+}
+
+template <typename T>
+DistanceResult<T> segmentSegmentDistance(const Segment3D<T>& lhs, const Segment3D<T>& rhs)
+{
+    if (!lhs.a.valid() || !lhs.b.valid() || !rhs.a.valid() || !rhs.b.valid())
+        return DistanceResult<T>{};
+
+    return closestOnSegments(lhs.a.coords.data(), lhs.b.coords.data(), rhs.a.coords.data(), rhs.b.coords.data());
+}
+
+// the point is a triangle with all vertices at it, whose edges are points too
+template <typename T>
+DistanceResult<T> pointTriangleDistance(const Point3D<T>& point, const Triangle3D<T>& tr)
+{
+    if (!point.valid() || !tr.valid())
+        return DistanceResult<T>{};
+
+    const T* coords = point.coords.data();
+    const T* face[3] = {tr[0].coords.data(), tr[1].coords.data(), tr[2].coords.data()};
+    const T* other[3] = {coords, coords, coords};
+
+    DistanceResult<T> best;
+    auto consider = [&](const DistanceResult<T>& candidate)
+    {
+        if (!best.valid() || candidate.distance < best.distance)
+            best = candidate;
+    };
+
+    faceCandidates(face, other, [&](const T* onFace, const T* onPoint)
+    {
+        consider(between(onPoint, onFace));
+    });
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+        consider(closestOnSegments(coords, coords, face[vertex], face[(vertex + 1) % 3]));
+
+    return best;
+}
+
+// Closest points of disjoint triangles are on two edges or a vertex and the other's face, intersecting
+// triangles have an edge crossing the other's face or, when coplanar, crossing edges or a vertex inside the
+// other. Ties go to the first candidate found.
+template <typename T>
+DistanceResult<T> triangleTriangleDistance(const Triangle3D<T>& lhs, const Triangle3D<T>& rhs)
+{
+    if (!lhs.valid() || !rhs.valid())
+        return DistanceResult<T>{};
+
+    const T* left[3] = {lhs[0].coords.data(), lhs[1].coords.data(), lhs[2].coords.data()};
+    const T* right[3] = {rhs[0].coords.data(), rhs[1].coords.data(), rhs[2].coords.data()};
+
+    DistanceResult<T> best;
+    auto consider = [&](const DistanceResult<T>& candidate)
+    {
+        if (!best.valid() || candidate.distance < best.distance)
+            best = candidate;
+    };
+
+    for (int first = 0; first < 3; ++first)
+        for (int second = 0; second < 3; ++second)
+            consider(closestOnSegments(left[first], left[(first + 1) % 3], right[second], right[(second + 1) % 3]));
+
+    faceCandidates(right, left, [&](const T* onRight, const T* onLeft)
+    {
+        consider(between(onLeft, onRight));
+    });
+
+    faceCandidates(left, right, [&](const T* onLeft, const T* onRight)
+    {
+        consider(between(onLeft, onRight));
+    });
+
+    return best;
+}
+
+template <typename T>
+DistanceScene<T>::DistanceScene(std::span<const Triangle3D<T>> triangles)
+{
+    std::vector<std::size_t> valid;
+    std::vector<AABB3D<T>> boxes;
+
+    for (std::size_t idx = 0; idx < triangles.size(); ++idx)
+    {
+        if (!triangles[idx].valid())
+            continue;
+
+        valid.push_back(idx);
+        boxes.push_back(triangles[idx].box());
+    }
+
+    bvh_.build(boxes);
+
+    triangles_.reserve(valid.size());
+    ids_.reserve(valid.size());
+
+    for (std::uint32_t pos : bvh_.order())
+    {
+        triangles_.push_back(triangles[valid[pos]]);
+        ids_.push_back(valid[pos]);
+    }
+
+    if (bvh_.empty())
+        return;
+
+    spanFirst_.resize(bvh_.nodes().size());
+    spanCount_.resize(bvh_.nodes().size());
+    computeSpans(0);
+}
+
+template <typename T>
+void DistanceScene<T>::computeSpans(std::uint32_t nodeIdx)
+{
+    const BVHNode<T>& node = bvh_.nodes()[nodeIdx];
+
+    if (node.leaf())
+    {
+        spanFirst_[nodeIdx] = node.first;
+        spanCount_[nodeIdx] = node.count;
+        return;
+    }
+
+    computeSpans(node.first);
+    computeSpans(node.first + 1);
+
+    spanFirst_[nodeIdx] = spanFirst_[node.first];
+    spanCount_[nodeIdx] = spanCount_[node.first] + spanCount_[node.first + 1];
+}
+
+// Branch and bound over pairs of nodes, nearer pairs first: a pair is dropped when its boxes are not closer
+// than the closest pair of triangles found so far. The triangles of a leaf are tested against small ranges of
+// the other scene with the kernel, and only the pairs the kernel finds closer get their witness points.
+template <typename T>
+DistanceResult<T> DistanceScene<T>::closest(const DistanceScene& other, T maxDistance) const
+{
+    DistanceResult<T> best;
+
+    if (empty() || other.empty() || !(maxDistance >= 0))
+        return best;
+
+    T bestSq = maxDistance * maxDistance;
+
+    const std::vector<BVHNode<T>>& lhsNodes = bvh_.nodes();
+    const std::vector<BVHNode<T>>& rhsNodes = other.bvh_.nodes();
+    const kernels::KernelTable<T>& kernel = kernels::activeKernels<T>();
+
+    T distances[KERNEL_RANGE];
+
+    // lhsLeaf tells whether the leaf belongs to this scene, pairs are reported in this scene's order either way
+    auto leafAgainstRange = [&](const DistanceScene& leafScene, std::uint32_t leaf,
+                                const DistanceScene& rangeScene, std::uint32_t rangeNode, bool lhsLeaf)
+    {
+        kernels::SoAView<T> view = makeView(rangeScene.triangles_);
+        std::uint32_t first = rangeScene.spanFirst_[rangeNode];
+        std::uint32_t last = first + rangeScene.spanCount_[rangeNode];
+
+        const BVHNode<T>& node = leafScene.bvh_.nodes()[leaf];
+
+        for (std::uint32_t idx = node.first; idx < node.first + node.count; ++idx)
+        {
+            Triangle3D<T> query = leafScene.triangles_[idx];
+
+            kernels::QueryData<T> data{};
+            for (int vertex = 0; vertex < 3; ++vertex)
+                for (int axis = 0; axis < 3; ++axis)
+                    data.vertex[vertex][axis] = query[vertex].coords[axis];
+
+            for (std::uint32_t begin = first; begin < last; begin += KERNEL_RANGE)
+            {
+                std::uint32_t end = std::min(last, begin + KERNEL_RANGE);
+                kernel.triangleDistance(data, view, begin, end, distances);
+
+                for (std::uint32_t pos = begin; pos < end; ++pos)
+                {
+                    if (!(distances[pos - begin] < bestSq))
+                        continue;
+
+                    Triangle3D<T> candidate = rangeScene.triangles_[pos];
+                    DistanceResult<T> result = lhsLeaf ? triangleTriangleDistance(query, candidate)
+                                                       : triangleTriangleDistance(candidate, query);
+
+                    if (!(result.distance * result.distance < bestSq))
+                        continue;
+
+                    best = result;
+                    best.firstTriangle = lhsLeaf ? leafScene.ids_[idx] : rangeScene.ids_[pos];
+                    best.secondTriangle = lhsLeaf ? rangeScene.ids_[pos] : leafScene.ids_[idx];
+                    bestSq = result.distance * result.distance;
+                }
+            }
+        }
+    };
+
+    struct NodePair
+    {
+        std::uint32_t lhs;
+        std::uint32_t rhs;
+    };
+
+    // a descent splits one node of the pair and leaves at most one pair behind
+    NodePair stack[2 * BVH<T>::MAX_DEPTH + 1];
+    std::size_t size = 0;
+
+    if (boxDistanceSq(lhsNodes[0], rhsNodes[0]) < bestSq)
+        stack[size++] = NodePair{0, 0};
+
+    while (size && bestSq > 0)
+    {
+        NodePair pair = stack[--size];
+        const BVHNode<T>& lhsNode = lhsNodes[pair.lhs];
+        const BVHNode<T>& rhsNode = rhsNodes[pair.rhs];
+
+        // the bound may have shrunk since the pair was pushed
+        if (!(boxDistanceSq(lhsNode, rhsNode) < bestSq))
+            continue;
+
+        if (lhsNode.leaf() && (rhsNode.leaf() || other.spanCount_[pair.rhs] <= KERNEL_RANGE))
+        {
+            leafAgainstRange(*this, pair.lhs, other, pair.rhs, true);
+            continue;
+        }
+
+        if (rhsNode.leaf() && spanCount_[pair.lhs] <= KERNEL_RANGE)
+        {
+            leafAgainstRange(other, pair.rhs, *this, pair.lhs, false);
+            continue;
+        }
+
+        // the node with more triangles is split
+        bool splitLhs = !lhsNode.leaf() && (rhsNode.leaf() || spanCount_[pair.lhs] >= other.spanCount_[pair.rhs]);
+
+        NodePair children[2] = {splitLhs ? NodePair{lhsNode.first, pair.rhs} : NodePair{pair.lhs, rhsNode.first},
+                                splitLhs ? NodePair{lhsNode.first + 1, pair.rhs} : NodePair{pair.lhs, rhsNode.first + 1}};
+
+        T childDistance[2];
+        for (int child = 0; child < 2; ++child)
+            childDistance[child] = boxDistanceSq(lhsNodes[children[child].lhs], rhsNodes[children[child].rhs]);
+
+        int nearer = (childDistance[1] < childDistance[0]) ? 1 : 0;
+
+        if (childDistance[1 - nearer] < bestSq)
+            stack[size++] = children[1 - nearer];
+        if (childDistance[nearer] < bestSq)
+            stack[size++] = children[nearer];
+    }
+
+    return best;
+}
+
+template DistanceResult<float> segmentSegmentDistance(const Segment3D<float>&, const Segment3D<float>&);
+template DistanceResult<float> pointTriangleDistance(const Point3D<float>&, const Triangle3D<float>&);
+template DistanceResult<float> triangleTriangleDistance(const Triangle3D<float>&, const Triangle3D<float>&);
+
+template DistanceResult<double> segmentSegmentDistance(const Segment3D<double>&, const Segment3D<double>&);
+template DistanceResult<double> pointTriangleDistance(const Point3D<double>&, const Triangle3D<double>&);
+template DistanceResult<double> triangleTriangleDistance(const Triangle3D<double>&, const Triangle3D<double>&);
+
+template class DistanceScene<float>;
+template class DistanceScene<double>;
+
+}
@@ -0,0 +1,258 @@
+#include <algorithm>
+
+#include "dynamic_bvh.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+template <typename T>
+AABB3D<T> unite(const AABB3D<T>& lhs, const AABB3D<T>& rhs)
+{
+    AABB3D<T> result;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        result.min.coords[axis] = std::min(lhs.min.coords[axis], rhs.min.coords[axis]);
+        result.max.coords[axis] = std::max(lhs.max.coords[axis], rhs.max.coords[axis]);
+    }
+
+    return result;
+}
+
+// half of the surface area
+template <typename T>
+T area(const AABB3D<T>& box)
+{
+    T x = box.max.coords[X] - box.min.coords[X];
+    T y = box.max.coords[Y] - box.min.coords[Y];
+    T z = box.max.coords[Z] - box.min.coords[Z];
+
+    return x * y + y * z + z * x;
+}
+
+}
+
+template <typename T>
+typename DynamicBVH<T>::Index DynamicBVH<T>::allocate()
+{
+    if (free_ == NONE)
+    {
+        nodes_.emplace_back();
+        return static_cast<Index>(nodes_.size() - 1);
+    }
+
+    Index idx = free_;
+    free_ = nodes_[idx].parent;
+    nodes_[idx] = Node{};
+
+    return idx;
+}
+
+template <typename T>
+void DynamicBVH<T>::release(Index idx)
+{
+    nodes_[idx].parent = free_;
+    nodes_[idx].height = -1;
+    free_ = idx;
+}
+
+// The sibling is searched from the root down: at every inner node the leaf either becomes the sibling of the
+// whole node or descends into the child whose subtree grows least, whatever is cheaper in added surface area.
+template <typename T>
+typename DynamicBVH<T>::Index DynamicBVH<T>::insert(const AABB3D<T>& box, Index item)
+{
+    Index leaf = allocate();
+    nodes_[leaf].box = box;
+    nodes_[leaf].item = item;
+    leaves_++;
+
+    if (root_ == NONE)
+    {
+        root_ = leaf;
+        return leaf;
+    }
+
+    Index sibling = root_;
+    while (!nodes_[sibling].leaf())
+    {
+        const Node& node = nodes_[sibling];
+
+        T nodeArea = area(node.box);
+        T combinedArea = area(unite(node.box, box));
+
+        // a new parent here costs its own area, going deeper makes this node grow anyway
+        T cost = 2 * combinedArea;
+        T inheritedCost = 2 * (combinedArea - nodeArea);
+
+        auto descendCost = [&](Index child)
+        {
+            const Node& childNode = nodes_[child];
+            T grown = area(unite(childNode.box, box));
+
+            return (childNode.leaf() ? grown : grown - area(childNode.box)) + inheritedCost;
+        };
+
+        T leftCost = descendCost(node.left);
+        T rightCost = descendCost(node.right);
+
+        if (cost < leftCost && cost < rightCost)
+            break;
+
+        sibling = (leftCost < rightCost) ? node.left : node.right;
+    }
+
+    Index oldParent = nodes_[sibling].parent;
+    Index parent = allocate();
+
+    nodes_[parent].parent = oldParent;
+    nodes_[parent].box = unite(nodes_[sibling].box, box);
+    nodes_[parent].height = nodes_[sibling].height + 1;
+    nodes_[parent].left = sibling;
+    nodes_[parent].right = leaf;
+
+    nodes_[sibling].parent = parent;
+    nodes_[leaf].parent = parent;
+
+    if (oldParent == NONE)
+        root_ = parent;
+    else if (nodes_[oldParent].left == sibling)
+        nodes_[oldParent].left = parent;
+    else
+        nodes_[oldParent].right = parent;
+
+    fixUpwards(oldParent);
+
+    return leaf;
+}
+
+// the leaf's parent is replaced by the leaf's sibling
+template <typename T>
+void DynamicBVH<T>::remove(Index leaf)
+{
+    leaves_--;
+
+    if (leaf == root_)
+    {
+        root_ = NONE;
+        release(leaf);
+        return;
+    }
+
+    Index parent = nodes_[leaf].parent;
+    Index grandParent = nodes_[parent].parent;
+    Index sibling = (nodes_[parent].left == leaf) ? nodes_[parent].right : nodes_[parent].left;
+
+    nodes_[sibling].parent = grandParent;
+
+    if (grandParent == NONE)
+        root_ = sibling;
+    else
+    {
+        if (nodes_[grandParent].left == parent)
+            nodes_[grandParent].left = sibling;
+        else
+            nodes_[grandParent].right = sibling;
+    }
+
+    release(parent);
+    release(leaf);
+
+    fixUpwards(grandParent);
+}
+
+template <typename T>
+void DynamicBVH<T>::refit(Index leaf, const AABB3D<T>& box)
+{
+    nodes_[leaf].box = box;
+
+    for (Index idx = nodes_[leaf].parent; idx != NONE; idx = nodes_[idx].parent)
+        nodes_[idx].box = unite(nodes_[nodes_[idx].left].box, nodes_[nodes_[idx].right].box);
+}
+
+template <typename T>
+void DynamicBVH<T>::fixUpwards(Index idx)
+{
+    while (idx != NONE)
+    {
+        rotate(idx);
+
+        Node& node = nodes_[idx];
+        node.height = 1 + std::max(nodes_[node.left].height, nodes_[node.right].height);
+        node.box = unite(nodes_[node.left].box, nodes_[node.right].box);
+
+        idx = node.parent;
+    }
+}
+
+// Swaps a child of a with a grandchild from the other side if that shrinks the inner node between them most:
+// for children b = (d, e) and c = (f, g), c can trade places with d or e, or b with f or g. Rotations only ever
+// reduce surface area, which keeps the tree as good for queries as insertion order allows.
+template <typename T>
+void DynamicBVH<T>::rotate(Index a)
+{
+    Index b = nodes_[a].left;
+    Index c = nodes_[a].right;
+
+    // child of a, the grandchild it swaps with and the node in between
+    Index bestChild = NONE, bestGrandChild = NONE, bestMiddle = NONE;
+    T bestGain = 0;
+
+    auto consider = [&](Index child, Index middle)
+    {
+        if (nodes_[middle].leaf())
+            return;
+
+        Index first = nodes_[middle].left;
+        Index second = nodes_[middle].right;
+        T current = area(nodes_[middle].box);
+
+        // child replaces first, middle then holds child and second
+        T gain = current - area(unite(nodes_[child].box, nodes_[second].box));
+        if (gain > bestGain)
+        {
+            bestGain = gain;
+            bestChild = child;
+            bestGrandChild = first;
+            bestMiddle = middle;
+        }
+
+        gain = current - area(unite(nodes_[child].box, nodes_[first].box));
+        if (gain > bestGain)
+        {
+            bestGain = gain;
+            bestChild = child;
+            bestGrandChild = second;
+            bestMiddle = middle;
+        }
+    };
+
+    consider(c, b);
+    consider(b, c);
+
+    if (bestChild == NONE)
+        return;
+
+    if (nodes_[a].left == bestChild)
+        nodes_[a].left = bestGrandChild;
+    else
+        nodes_[a].right = bestGrandChild;
+    nodes_[bestGrandChild].parent = a;
+
+    if (nodes_[bestMiddle].left == bestGrandChild)
+        nodes_[bestMiddle].left = bestChild;
+    else
+        nodes_[bestMiddle].right = bestChild;
+    nodes_[bestChild].parent = bestMiddle;
+
+    Node& middle = nodes_[bestMiddle];
+    middle.box = unite(nodes_[middle.left].box, nodes_[middle.right].box);
+    middle.height = 1 + std::max(nodes_[middle.left].height, nodes_[middle.right].height);
+}
+
+template class DynamicBVH<float>;
+template class DynamicBVH<double>;
+
+}
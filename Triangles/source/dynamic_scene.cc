@@ -0,0 +1,222 @@
+#include <algorithm>
+
+#include "dynamic_scene.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+template <typename T>
+bool inside(const AABB3D<T>& inner, const AABB3D<T>& outer)
+{
+    for (int axis = 0; axis < 3; ++axis)
+        if (inner.min.coords[axis] < outer.min.coords[axis] || inner.max.coords[axis] > outer.max.coords[axis])
+            return false;
+
+    return true;
+}
+
+template <typename T>
+AABB3D<T> enlarge(const AABB3D<T>& box, T margin)
+{
+    AABB3D<T> result = box;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        result.min.coords[axis] -= margin;
+        result.max.coords[axis] += margin;
+    }
+
+    return result;
+}
+
+template <typename Id>
+std::pair<Id, Id> makePair(Id lhs, Id rhs)
+{
+    return std::minmax(lhs, rhs);
+}
+
+}
+
+template <typename T>
+typename DynamicScene<T>::Id DynamicScene<T>::insert(const Triangle3D<T>& tr)
+{
+    Id id;
+
+    if (free_.empty())
+    {
+        id = static_cast<Id>(entries_.size());
+        entries_.push_back(Entry{tr});
+    }
+    else
+    {
+        id = free_.back();
+        free_.pop_back();
+        entries_[id] = Entry{tr};
+    }
+
+    size_++;
+
+    place(id);
+    markDirty(id);
+
+    return id;
+}
+
+template <typename T>
+void DynamicScene<T>::update(Id id, const Triangle3D<T>& tr)
+{
+    entries_[id].triangle = tr;
+
+    place(id);
+    markDirty(id);
+}
+
+template <typename T>
+void DynamicScene<T>::remove(Id id)
+{
+    Entry& entry = entries_[id];
+
+    if (entry.leaf != DynamicBVH<T>::NONE)
+        tree_.remove(entry.leaf);
+
+    entry.leaf = DynamicBVH<T>::NONE;
+    entry.alive = false;
+    size_--;
+
+    removed_.push_back(id);
+    released_.push_back(id);
+}
+
+template <typename T>
+void DynamicScene<T>::place(Id id)
+{
+    Entry& entry = entries_[id];
+
+    if (!entry.triangle.valid())
+    {
+        if (entry.leaf != DynamicBVH<T>::NONE)
+            tree_.remove(entry.leaf);
+
+        entry.leaf = DynamicBVH<T>::NONE;
+        return;
+    }
+
+    const AABB3D<T>& box = entry.triangle.box();
+
+    if (entry.leaf == DynamicBVH<T>::NONE)
+    {
+        entry.leaf = tree_.insert(enlarge(box, margin_), id);
+        return;
+    }
+
+    const AABB3D<T>& enlarged = tree_.box(entry.leaf);
+
+    if (inside(box, enlarged))
+        return;
+
+    if (enlarged.overlaps(box))
+        tree_.refit(entry.leaf, enlarge(box, margin_));
+    else
+    {
+        tree_.remove(entry.leaf);
+        entry.leaf = tree_.insert(enlarge(box, margin_), id);
+    }
+}
+
+template <typename T>
+void DynamicScene<T>::markDirty(Id id)
+{
+    if (!entries_[id].dirty)
+    {
+        entries_[id].dirty = true;
+        dirty_.push_back(id);
+    }
+}
+
+// Partner lists always hold the pairs of the last commit except for the triangles already handled in this one,
+// which makes every changed pair be reported exactly once: a pair of two edited triangles is found by the first
+// of them, and the second one sees it already in its list.
+template <typename T>
+typename DynamicScene<T>::Changes DynamicScene<T>::commit()
+{
+    Changes changes;
+
+    auto erasePartner = [&](Id from, Id partner)
+    {
+        std::vector<Id>& partners = entries_[from].partners;
+        partners.erase(std::find(partners.begin(), partners.end(), partner));
+    };
+
+    for (Id id : removed_)
+    {
+        for (Id partner : entries_[id].partners)
+        {
+            erasePartner(partner, id);
+            changes.removed.push_back(makePair(id, partner));
+        }
+
+        entries_[id].partners.clear();
+    }
+
+    std::vector<Id> current;
+
+    for (Id id : dirty_)
+    {
+        Entry& entry = entries_[id];
+        entry.dirty = false;
+
+        if (!entry.alive)
+            continue;
+
+        current.clear();
+
+        if (entry.leaf != DynamicBVH<T>::NONE)
+            tree_.query(entry.triangle.box(), [&](Id other)
+            {
+                if (other != id && triangleTriangleIntersect(entry.triangle, entries_[other].triangle))
+                    current.push_back(other);
+            });
+
+        std::sort(current.begin(), current.end());
+        std::sort(entry.partners.begin(), entry.partners.end());
+
+        std::vector<Id> gone;
+        std::set_difference(entry.partners.begin(), entry.partners.end(), current.begin(), current.end(),
+                            std::back_inserter(gone));
+        for (Id partner : gone)
+        {
+            erasePartner(partner, id);
+            changes.removed.push_back(makePair(id, partner));
+        }
+
+        std::vector<Id> appeared;
+        std::set_difference(current.begin(), current.end(), entry.partners.begin(), entry.partners.end(),
+                            std::back_inserter(appeared));
+        for (Id partner : appeared)
+        {
+            entries_[partner].partners.push_back(id);
+            changes.added.push_back(makePair(id, partner));
+        }
+
+        entry.partners = current;
+    }
+
+    dirty_.clear();
+    removed_.clear();
+
+    free_.insert(free_.end(), released_.begin(), released_.end());
+    released_.clear();
+
+    std::sort(changes.added.begin(), changes.added.end());
+    std::sort(changes.removed.begin(), changes.removed.end());
+
+    return changes;
+}
+
+template class DynamicScene<float>;
+template class DynamicScene<double>;
+
+}
@@ -0,0 +1,65 @@
+#include <algorithm>
+
+#include "indexed_mesh.hh"
+
+namespace geometry3D
+{
+
+// Sweep and prune along x: faces are sorted by the lower x bound of their boxes, so every face only has to be
+// compared with the following ones until their lower bound passes its upper one.
+template <typename T>
+std::vector<std::size_t> intersectingTriangles(const IndexedMesh<T>& mesh)
+{
+    std::size_t size = mesh.faceCount();
+
+    std::vector<AABB3D<T>> boxes;
+    boxes.reserve(size);
+    for (std::size_t idx = 0; idx < size; ++idx)
+        boxes.push_back(mesh.triangle(idx).box());
+
+    // faces with invalid vertices intersect nothing and their nan keys would break the sort
+    std::vector<std::size_t> order;
+    order.reserve(size);
+    for (std::size_t idx = 0; idx < size; ++idx)
+        if (mesh.triangle(idx).valid())
+            order.push_back(idx);
+
+    std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs)
+    {
+        return boxes[lhs].min.coords[X] < boxes[rhs].min.coords[X];
+    });
+
+    std::vector<bool> intersecting(size, false);
+
+    for (std::size_t first = 0; first < order.size(); ++first)
+    {
+        std::size_t query = order[first];
+        Triangle3D<T> queryTr = mesh.triangle(query);
+
+        for (std::size_t second = first + 1; second < order.size(); ++second)
+        {
+            std::size_t other = order[second];
+
+            if (boxes[other].min.coords[X] > boxes[query].max.coords[X] + EPS<T>)
+                break;
+
+            if (!boxes[query].overlaps(boxes[other]) || mesh.adjacent(query, other))
+                continue;
+
+            if (triangleTriangleIntersect(queryTr, mesh.triangle(other)))
+                intersecting[query] = intersecting[other] = true;
+        }
+    }
+
+    std::vector<std::size_t> result;
+    for (std::size_t idx = 0; idx < size; ++idx)
+        if (intersecting[idx])
+            result.push_back(idx);
+
+    return result;
+}
+
+template std::vector<std::size_t> intersectingTriangles(const IndexedMesh<float>&);
+template std::vector<std::size_t> intersectingTriangles(const IndexedMesh<double>&);
+
+}
@@ -1,77 +1,422 @@
+#include <algorithm>
+
 #include "geometry3D.hh"
+#include "predicates.hh"
 
 namespace geometry3D
 {
 
-// needs explanation comment
-Point3D lineLineIntersect(const Line3D& lhs, const Line3D& rhs)
+// Lines r1 + d1 * t1 and r2 + d2 * t2 have to be coplanar and not parallel. The intersection parameter on
+// the first one is t1 = ((r2 - r1) x d2) * (d1 x d2) / |d1 x d2|^2
+template <typename T>
+Point3D<T> lineLineIntersect(const Line3D<T>& lhs, const Line3D<T>& rhs)
 {
     if (!lhs.valid() || !rhs.valid())
-        return Point3D{};
+        return Point3D<T>{};
 
     if (lhs.collinearToVector(rhs.direction))
-        return Point3D{};
-
+        return Point3D<T>{};
 
-    Vector3D startingPointsDifference{lhs.point, rhs.point};
-    if (!floatZero(startingPointsDifference.scalarProduct(lhs.direction.crossProduct(rhs.direction))))
-        return Point3D{};
+    Vector3D<T> cross = lhs.direction.crossProduct(rhs.direction);
 
-    float_t det = lhs.direction.coords[Y] * rhs.direction.coords[X] - lhs.direction.coords[X] * rhs.direction.coords[Y];
+    Vector3D<T> startingPointsDifference{lhs.point, rhs.point};
+    if (!floatZero(startingPointsDifference.scalarProduct(cross)))
+        return Point3D<T>{};
 
-    float_t detT1 = lhs.direction.coords[Y] * (rhs.point.coords[X] - lhs.point.coords[X]) -
-                    lhs.direction.coords[X] * (rhs.point.coords[Y] - lhs.point.coords[Y]);
+    T t1 = startingPointsDifference.crossProduct(rhs.direction).scalarProduct(cross) / cross.scalarProduct(cross);
+    Vector3D<T> r0{lhs.point.coords[X], lhs.point.coords[Y], lhs.point.coords[Z]};
 
-    float_t t1 = detT1 / det;
-    Vector3D r0{lhs.point.coords[X], lhs.point.coords[Y], lhs.point.coords[Z]};
+    Vector3D<T> radiusVectorOfIntersec{r0 + lhs.direction * t1};
 
-    Vector3D radiusVectorOfIntersec{r0 + lhs.direction * t1};
-
-    return Point3D{radiusVectorOfIntersec.coords[X], radiusVectorOfIntersec.coords[Y], radiusVectorOfIntersec.coords[Z]};
+    return Point3D<T>{radiusVectorOfIntersec.coords[X], radiusVectorOfIntersec.coords[Y], radiusVectorOfIntersec.coords[Z]};
 }
 
-// needs explanation comment
-Point3D planeLineIntersect(const Plane3D& plane, const Line3D& line)
+// Point r0 + dir * t lies on the plane when norm * (r0 + dir * t) + d = 0, so t = -(norm * r0 + d) / (norm * dir)
+template <typename T>
+Point3D<T> planeLineIntersect(const Plane3D<T>& plane, const Line3D<T>& line)
 {
     if (!plane.valid() || !line.valid())
-        return Point3D{};
+        return Point3D<T>{};
 
     if (floatZero(plane.norm.scalarProduct(line.direction)))
-        return Point3D{};
+        return Point3D<T>{};
 
-    Vector3D r0{line.point.coords[X], line.point.coords[Y], line.point.coords[Z]};
+    Vector3D<T> r0{line.point.coords[X], line.point.coords[Y], line.point.coords[Z]};
 
-    float_t t = (plane.norm.scalarProduct(r0) + plane.d) / (plane.norm.scalarProduct(line.direction));
+    T t = -(plane.norm.scalarProduct(r0) + plane.d) / (plane.norm.scalarProduct(line.direction));
 
-    Vector3D radiusVectorOfIntersec{r0 + line.direction * t};
+    Vector3D<T> radiusVectorOfIntersec{r0 + line.direction * t};
 
-    return Point3D{radiusVectorOfIntersec.coords[X], radiusVectorOfIntersec.coords[Y], radiusVectorOfIntersec.coords[Z]};
+    return Point3D<T>{radiusVectorOfIntersec.coords[X], radiusVectorOfIntersec.coords[Y], radiusVectorOfIntersec.coords[Z]};
 }
 
-Point3D planeLineIntersect(const Line3D& line, const Plane3D& plane)
+template <typename T>
+Point3D<T> planeLineIntersect(const Line3D<T>& line, const Plane3D<T>& plane)
 {
     return planeLineIntersect(plane, line);
 }
 
 
-bool planePointIntersect(const Plane3D& plane, const Point3D& point)
+template <typename T>
+bool planePointIntersect(const Plane3D<T>& plane, const Point3D<T>& point)
 {
     if (!plane.valid() || !point.valid())
         return false;
 
-    Vector3D r0{point.coords[X], point.coords[Y], point.coords[Z]};
+    Vector3D<T> r0{point.coords[X], point.coords[Y], point.coords[Z]};
 
-    if (floatZero(r0.scalarProduct(plane.norm)))
+    if (floatZero(r0.scalarProduct(plane.norm) + plane.d))
         return true;
 
     return false;
 
 }
 
-bool planePointIntersect(const Point3D& point, const Plane3D& plane)
+template <typename T>
+bool planePointIntersect(const Point3D<T>& point, const Plane3D<T>& plane)
 {
     return planePointIntersect(plane, point);
 }
 
+namespace
+{
+
+template <typename T>
+struct Point2D
+{
+    T x;
+    T y;
+};
+
+// coplanar figures are projected on the coordinate plane where the normal's projection is the longest
+template <typename T>
+Axis dominantAxis(const Vector3D<T>& normal)
+{
+    T x = std::abs(normal.coords[X]);
+    T y = std::abs(normal.coords[Y]);
+    T z = std::abs(normal.coords[Z]);
+
+    if (x >= y && x >= z)
+        return X;
+
+    return (y >= z) ? Y : Z;
+}
+
+template <typename T>
+Point2D<T> project(const Point3D<T>& point, Axis dropped)
+{
+    switch (dropped)
+    {
+        case X:  return Point2D<T>{point.coords[Y], point.coords[Z]};
+        case Y:  return Point2D<T>{point.coords[X], point.coords[Z]};
+        default: return Point2D<T>{point.coords[X], point.coords[Y]};
+    }
+}
+
+template <typename T>
+int orientation2D(Point2D<T> origin, Point2D<T> a, Point2D<T> b)
+{
+    return orient2d(origin.x, origin.y, a.x, a.y, b.x, b.y);
+}
+
+// point known to be collinear with the segment
+template <typename T>
+bool onSegment2D(Point2D<T> point, Point2D<T> a, Point2D<T> b)
+{
+    return point.x <= std::max(a.x, b.x) && point.x >= std::min(a.x, b.x) &&
+           point.y <= std::max(a.y, b.y) && point.y >= std::min(a.y, b.y);
+}
+
+template <typename T>
+bool segmentSegmentIntersect2D(Point2D<T> p1, Point2D<T> p2, Point2D<T> q1, Point2D<T> q2)
+{
+    int o1 = orientation2D(p1, p2, q1);
+    int o2 = orientation2D(p1, p2, q2);
+    int o3 = orientation2D(q1, q2, p1);
+    int o4 = orientation2D(q1, q2, p2);
+
+    if (o1 * o2 < 0 && o3 * o4 < 0)
+        return true;
+
+    return (o1 == 0 && onSegment2D(q1, p1, p2)) || (o2 == 0 && onSegment2D(q2, p1, p2)) ||
+           (o3 == 0 && onSegment2D(p1, q1, q2)) || (o4 == 0 && onSegment2D(p2, q1, q2));
+}
+
+template <typename T>
+bool pointInTriangle2D(Point2D<T> point, const Point2D<T> tr[3])
+{
+    int o1 = orientation2D(tr[0], tr[1], point);
+    int o2 = orientation2D(tr[1], tr[2], point);
+    int o3 = orientation2D(tr[2], tr[0], point);
+
+    bool hasNeg = (o1 < 0) || (o2 < 0) || (o3 < 0);
+    bool hasPos = (o1 > 0) || (o2 > 0) || (o3 > 0);
+
+    return !(hasNeg && hasPos);
+}
+
+template <typename T>
+bool segmentTriangleIntersect2D(Point2D<T> a, Point2D<T> b, const Point2D<T> tr[3])
+{
+    if (pointInTriangle2D(a, tr) || pointInTriangle2D(b, tr))
+        return true;
+
+    for (int i = 0; i < 3; ++i)
+        if (segmentSegmentIntersect2D(a, b, tr[i], tr[(i + 1) % 3]))
+            return true;
+
+    return false;
+}
+
+template <typename T>
+bool coplanarTrianglesIntersect(const Triangle3D<T>& lhs, const Triangle3D<T>& rhs)
+{
+    Axis dropped = dominantAxis(lhs.normal());
+
+    Point2D<T> first[3] = {project(lhs[0], dropped), project(lhs[1], dropped), project(lhs[2], dropped)};
+    Point2D<T> second[3] = {project(rhs[0], dropped), project(rhs[1], dropped), project(rhs[2], dropped)};
+
+    for (int i = 0; i < 3; ++i)
+        if (segmentTriangleIntersect2D(first[i], first[(i + 1) % 3], second))
+            return true;
+
+    return pointInTriangle2D(second[0], first);
+}
+
+// exactly: all of the vertices' projections on the coordinate planes are collinear
+template <typename T>
+bool collinear(const Triangle3D<T>& tr)
+{
+    for (Axis dropped : {X, Y, Z})
+    {
+        Point2D<T> a = project(tr[0], dropped), b = project(tr[1], dropped), c = project(tr[2], dropped);
+        if (orientation2D(a, b, c) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+// collinear triangle is the segment between its extreme vertices, which may as well be a single point
+template <typename T>
+Segment3D<T> hull(const Triangle3D<T>& tr)
+{
+    auto less = [](const Point3D<T>& lhs, const Point3D<T>& rhs) { return lhs.coords < rhs.coords; };
+
+    return Segment3D<T>{std::min({tr[0], tr[1], tr[2]}, less), std::max({tr[0], tr[1], tr[2]}, less)};
+}
+
+// coplanar segments intersect iff their projections on every coordinate plane do:
+// at least one of the projections keeps the plane they lie in undistorted
+template <typename T>
+bool segmentSegmentIntersect(const Segment3D<T>& lhs, const Segment3D<T>& rhs)
+{
+    if (orient3d(lhs.a, lhs.b, rhs.a, rhs.b) != 0)
+        return false;
+
+    for (Axis dropped : {X, Y, Z})
+        if (!segmentSegmentIntersect2D(project(lhs.a, dropped), project(lhs.b, dropped),
+                                       project(rhs.a, dropped), project(rhs.b, dropped)))
+            return false;
+
+    return true;
+}
+
+template <typename T>
+bool segmentTriangleIntersect(const Segment3D<T>& segment, const Triangle3D<T>& tr)
+{
+    int sideA = orient3d(tr[0], tr[1], tr[2], segment.a);
+    int sideB = orient3d(tr[0], tr[1], tr[2], segment.b);
+
+    if (sideA * sideB > 0)
+        return false;
+
+    if (sideA == 0 && sideB == 0)
+    {
+        Axis dropped = dominantAxis(tr.normal());
+        Point2D<T> projected[3] = {project(tr[0], dropped), project(tr[1], dropped), project(tr[2], dropped)};
+
+        return segmentTriangleIntersect2D(project(segment.a, dropped), project(segment.b, dropped), projected);
+    }
+
+    // the segment reaches the plane, so it hits the triangle iff its line passes every edge on the same side
+    int o1 = orient3d(segment.a, segment.b, tr[0], tr[1]);
+    int o2 = orient3d(segment.a, segment.b, tr[1], tr[2]);
+    int o3 = orient3d(segment.a, segment.b, tr[2], tr[0]);
+
+    bool hasNeg = (o1 < 0) || (o2 < 0) || (o3 < 0);
+    bool hasPos = (o1 > 0) || (o2 > 0) || (o3 > 0);
+
+    return !(hasNeg && hasPos);
+}
+
+// O. Devillers, P. Guigue, "Faster Triangle-Triangle Intersection Tests", 2002.
+// The triangles are permuted so that p1 is alone on its side of the second triangle's plane and p2 alone on
+// its side of the first one's, then the intervals on the planes' common line overlap iff both checks pass.
+template <typename T>
+bool checkMinMax(const Point3D<T>& p1, const Point3D<T>& q1, const Point3D<T>& r1,
+                 const Point3D<T>& p2, const Point3D<T>& q2, const Point3D<T>& r2)
+{
+    if (orient3d(q2, p2, p1, q1) > 0)
+        return false;
+
+    return orient3d(r2, p2, r1, p1) <= 0;
+}
+
+template <typename T>
+bool permutedIntersect(const Point3D<T>& p1, const Point3D<T>& q1, const Point3D<T>& r1,
+                       const Point3D<T>& p2, const Point3D<T>& q2, const Point3D<T>& r2,
+                       int dp2, int dq2, int dr2, const Triangle3D<T>& lhs, const Triangle3D<T>& rhs)
+{
+    if (dp2 > 0)
+    {
+        if (dq2 > 0)
+            return checkMinMax(p1, r1, q1, r2, p2, q2);
+        if (dr2 > 0)
+            return checkMinMax(p1, r1, q1, q2, r2, p2);
+        return checkMinMax(p1, q1, r1, p2, q2, r2);
+    }
+
+    if (dp2 < 0)
+    {
+        if (dq2 < 0)
+            return checkMinMax(p1, q1, r1, r2, p2, q2);
+        if (dr2 < 0)
+            return checkMinMax(p1, q1, r1, q2, r2, p2);
+        return checkMinMax(p1, r1, q1, p2, q2, r2);
+    }
+
+    if (dq2 < 0)
+    {
+        if (dr2 >= 0)
+            return checkMinMax(p1, r1, q1, q2, r2, p2);
+        return checkMinMax(p1, q1, r1, p2, q2, r2);
+    }
+
+    if (dq2 > 0)
+    {
+        if (dr2 > 0)
+            return checkMinMax(p1, r1, q1, p2, q2, r2);
+        return checkMinMax(p1, q1, r1, q2, r2, p2);
+    }
+
+    if (dr2 > 0)
+        return checkMinMax(p1, q1, r1, r2, p2, q2);
+    if (dr2 < 0)
+        return checkMinMax(p1, r1, q1, r2, p2, q2);
+
+    return coplanarTrianglesIntersect(lhs, rhs);
+}
+
+}
+
+template <typename T>
+bool triangleTriangleIntersect(const Triangle3D<T>& lhs, const Triangle3D<T>& rhs, TriangleTestStage& stage)
+{
+    // nan boxes overlap everything
+    stage = TriangleTestStage::Degenerate;
+    if (!lhs.valid() || !rhs.valid())
+        return false;
+
+    stage = TriangleTestStage::Boxes;
+    if (!lhs.box().overlaps(rhs.box()))
+        return false;
+
+    bool lhsCollinear = collinear(lhs);
+    bool rhsCollinear = collinear(rhs);
+
+    stage = TriangleTestStage::Degenerate;
+    if (lhsCollinear && rhsCollinear)
+        return segmentSegmentIntersect(hull(lhs), hull(rhs));
+
+    if (lhsCollinear)
+        return segmentTriangleIntersect(hull(lhs), rhs);
+
+    if (rhsCollinear)
+        return segmentTriangleIntersect(hull(rhs), lhs);
+
+    const Point3D<T> &p1 = lhs[0], &q1 = lhs[1], &r1 = lhs[2];
+    const Point3D<T> &p2 = rhs[0], &q2 = rhs[1], &r2 = rhs[2];
+
+    int dp1 = orient3d(p1, p2, q2, r2);
+    int dq1 = orient3d(q1, p2, q2, r2);
+    int dr1 = orient3d(r1, p2, q2, r2);
+
+    stage = TriangleTestStage::FirstPlane;
+    if (dp1 * dq1 > 0 && dp1 * dr1 > 0)
+        return false;
+
+    int dp2 = orient3d(p2, q1, r1, p1);
+    int dq2 = orient3d(q2, q1, r1, p1);
+    int dr2 = orient3d(r2, q1, r1, p1);
+
+    stage = TriangleTestStage::SecondPlane;
+    if (dp2 * dq2 > 0 && dp2 * dr2 > 0)
+        return false;
+
+    stage = TriangleTestStage::Intervals;
+    if (dp1 > 0)
+    {
+        if (dq1 > 0)
+            return permutedIntersect(r1, p1, q1, p2, r2, q2, dp2, dr2, dq2, lhs, rhs);
+        if (dr1 > 0)
+            return permutedIntersect(q1, r1, p1, p2, r2, q2, dp2, dr2, dq2, lhs, rhs);
+        return permutedIntersect(p1, q1, r1, p2, q2, r2, dp2, dq2, dr2, lhs, rhs);
+    }
+
+    if (dp1 < 0)
+    {
+        if (dq1 < 0)
+            return permutedIntersect(r1, p1, q1, p2, q2, r2, dp2, dq2, dr2, lhs, rhs);
+        if (dr1 < 0)
+            return permutedIntersect(q1, r1, p1, p2, q2, r2, dp2, dq2, dr2, lhs, rhs);
+        return permutedIntersect(p1, q1, r1, p2, r2, q2, dp2, dr2, dq2, lhs, rhs);
+    }
+
+    if (dq1 < 0)
+    {
+        if (dr1 >= 0)
+            return permutedIntersect(q1, r1, p1, p2, r2, q2, dp2, dr2, dq2, lhs, rhs);
+        return permutedIntersect(p1, q1, r1, p2, q2, r2, dp2, dq2, dr2, lhs, rhs);
+    }
+
+    if (dq1 > 0)
+    {
+        if (dr1 > 0)
+            return permutedIntersect(p1, q1, r1, p2, r2, q2, dp2, dr2, dq2, lhs, rhs);
+        return permutedIntersect(q1, r1, p1, p2, q2, r2, dp2, dq2, dr2, lhs, rhs);
+    }
+
+    if (dr1 > 0)
+        return permutedIntersect(r1, p1, q1, p2, q2, r2, dp2, dq2, dr2, lhs, rhs);
+    if (dr1 < 0)
+        return permutedIntersect(r1, p1, q1, p2, r2, q2, dp2, dr2, dq2, lhs, rhs);
+
+    stage = TriangleTestStage::Coplanar;
+    return coplanarTrianglesIntersect(lhs, rhs);
+}
+
+template <typename T>
+bool triangleTriangleIntersect(const Triangle3D<T>& lhs, const Triangle3D<T>& rhs)
+{
+    TriangleTestStage stage;
+    return triangleTriangleIntersect(lhs, rhs, stage);
 }
 
+template Point3D<float> lineLineIntersect(const Line3D<float>&, const Line3D<float>&);
+template Point3D<float> planeLineIntersect(const Plane3D<float>&, const Line3D<float>&);
+template Point3D<float> planeLineIntersect(const Line3D<float>&, const Plane3D<float>&);
+template bool planePointIntersect(const Plane3D<float>&, const Point3D<float>&);
+template bool planePointIntersect(const Point3D<float>&, const Plane3D<float>&);
+template bool triangleTriangleIntersect(const Triangle3D<float>&, const Triangle3D<float>&);
+template bool triangleTriangleIntersect(const Triangle3D<float>&, const Triangle3D<float>&, TriangleTestStage&);
+
+template Point3D<double> lineLineIntersect(const Line3D<double>&, const Line3D<double>&);
+template Point3D<double> planeLineIntersect(const Plane3D<double>&, const Line3D<double>&);
+template Point3D<double> planeLineIntersect(const Line3D<double>&, const Plane3D<double>&);
+template bool planePointIntersect(const Plane3D<double>&, const Point3D<double>&);
+template bool planePointIntersect(const Point3D<double>&, const Plane3D<double>&);
+template bool triangleTriangleIntersect(const Triangle3D<double>&, const Triangle3D<double>&);
+template bool triangleTriangleIntersect(const Triangle3D<double>&, const Triangle3D<double>&, TriangleTestStage&);
+
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "line_batch.hh"
+#include "soa_kernels.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+template <typename T>
+kernels::LineView<T> makeView(const LineBatch<T>& lines)
+{
+    kernels::LineView<T> view;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        view.point[axis] = lines.point(static_cast<Axis>(axis));
+        view.direction[axis] = lines.direction(static_cast<Axis>(axis));
+    }
+
+    return view;
+}
+
+template <typename T>
+kernels::PointView<T> makeView(const PointBatch<T>& points)
+{
+    kernels::PointView<T> view;
+
+    for (int axis = 0; axis < 3; ++axis)
+        view.coord[axis] = points.coord(static_cast<Axis>(axis));
+
+    return view;
+}
+
+void checkOutput(std::size_t outputSize, std::size_t batchSize)
+{
+    if (outputSize < batchSize)
+        throw std::length_error{"output of a batched query is shorter than the batch"};
+}
+
+template <typename T>
+kernels::PointOutput<T> makeOutput(IntersectionOutput<T> out, std::size_t size)
+{
+    checkOutput(out.x.size(), size);
+    checkOutput(out.y.size(), size);
+    checkOutput(out.z.size(), size);
+    checkOutput(out.hit.size(), size);
+
+    return kernels::PointOutput<T>{{out.x.data(), out.y.data(), out.z.data()}, out.hit.data()};
+}
+
+template <typename T>
+kernels::PlaneData<T> makePlane(const Plane3D<T>& plane)
+{
+    return kernels::PlaneData<T>{{plane.norm.coords[X], plane.norm.coords[Y], plane.norm.coords[Z]}, plane.d, EPS<T>};
+}
+
+}
+
+template <typename T>
+void planeLineIntersect(const Plane3D<T>& plane, const LineBatch<T>& lines, IntersectionOutput<T> out)
+{
+    kernels::PointOutput<T> output = makeOutput(out, lines.size());
+
+    if (!plane.valid())
+    {
+        std::fill_n(output.hit, lines.size(), 0);
+        return;
+    }
+
+    kernels::activeKernels<T>().planeLine(makePlane(plane), makeView(lines), lines.size(), output);
+}
+
+template <typename T>
+void lineLineIntersect(const Line3D<T>& query, const LineBatch<T>& lines, IntersectionOutput<T> out)
+{
+    kernels::PointOutput<T> output = makeOutput(out, lines.size());
+
+    if (!query.valid())
+    {
+        std::fill_n(output.hit, lines.size(), 0);
+        return;
+    }
+
+    kernels::LineData<T> data;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        data.point[axis] = query.point.coords[axis];
+        data.direction[axis] = query.direction.coords[axis];
+    }
+    data.eps = EPS<T>;
+
+    kernels::activeKernels<T>().lineLine(data, makeView(lines), lines.size(), output);
+}
+
+template <typename T>
+void planePointIntersect(const Plane3D<T>& plane, const PointBatch<T>& points, std::span<std::uint8_t> hit)
+{
+    checkOutput(hit.size(), points.size());
+
+    if (!plane.valid())
+    {
+        std::fill_n(hit.data(), points.size(), 0);
+        return;
+    }
+
+    kernels::activeKernels<T>().planePoint(makePlane(plane), makeView(points), points.size(), hit.data());
+}
+
+template void planeLineIntersect(const Plane3D<float>&, const LineBatch<float>&, IntersectionOutput<float>);
+template void lineLineIntersect(const Line3D<float>&, const LineBatch<float>&, IntersectionOutput<float>);
+template void planePointIntersect(const Plane3D<float>&, const PointBatch<float>&, std::span<std::uint8_t>);
+
+template void planeLineIntersect(const Plane3D<double>&, const LineBatch<double>&, IntersectionOutput<double>);
+template void lineLineIntersect(const Line3D<double>&, const LineBatch<double>&, IntersectionOutput<double>);
+template void planePointIntersect(const Plane3D<double>&, const PointBatch<double>&, std::span<std::uint8_t>);
+
+}
@@ -1,7 +1,91 @@
-#include "geometry3D.hh"
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
+#include "tiled_intersection.hh"
+#include "triangle_io.hh"
+#include "triangle_soa.hh"
 
-int main()
+
+namespace
+{
+
+// bytes in the given number of MiB
+std::size_t parseMemory(const char* text)
 {
+    const char* end = text + std::strlen(text);
+    std::uint64_t mebibytes = 0;
+
+    // a minus sign is an error rather than a wrapped value as with stoull
+    auto [ptr, error] = std::from_chars(text, end, mebibytes);
+    if (*text == '-' || error != std::errc{} || ptr != end || mebibytes == 0 ||
+        mebibytes > (std::numeric_limits<std::size_t>::max() >> 20))
+        throw std::runtime_error{"--memory takes a positive number of MiB, got \"" + std::string{text} + "\""};
+
+    return static_cast<std::size_t>(mebibytes) << 20;
+}
+
+}
+
+// Prints the indices of the triangles intersecting any other one. Triangles are read from the file given as the
+// argument, binary STL if its name ends with .stl, or from the standard input in the text format.
+// With --memory MiB before the file, the file is processed out of core within that much memory.
+int main(int argc, char* argv[])
+{
+    try
+    {
+        if (argc > 1 && std::string{argv[1]} == "--memory")
+        {
+            if (argc != 4)
+            {
+                std::cerr << "usage: " << argv[0] << " --memory MiB file" << std::endl;
+                return 1;
+            }
+
+            geometry3D::TilingOptions options;
+            options.memoryBudget = parseMemory(argv[2]);
+
+            std::vector<bool> intersecting = geometry3D::intersectingTrianglesOutOfCore<double>(argv[3], options);
+
+            for (std::size_t idx = 0; idx < intersecting.size(); ++idx)
+                if (intersecting[idx])
+                    std::cout << idx << '\n';
+
+            return 0;
+        }
+
+        geometry3D::TriangleSoA<double> triangles;
+
+        if (argc > 1)
+        {
+            std::string path = argv[1];
+
+            if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".stl") == 0)
+                triangles = geometry3D::loadStl<double>(path);
+            else
+                triangles = geometry3D::loadTriangles<double>(path);
+        }
+        else
+        {
+            std::string input{std::istreambuf_iterator<char>{std::cin}, std::istreambuf_iterator<char>{}};
+            triangles = geometry3D::parseTriangles<double>(input);
+        }
+
+        for (std::size_t idx : geometry3D::intersectingTriangles(triangles))
+            std::cout << idx << '\n';
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include "morton.hh"
+#include "parallel.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+// smaller inputs are not worth a thread
+constexpr std::size_t MIN_CHUNK_SIZE = 1 << 16;
+
+constexpr unsigned DIGIT_BITS = 8;
+constexpr std::size_t RADIX = std::size_t{1} << DIGIT_BITS;
+
+// sorts after every code of a valid triangle
+constexpr std::uint64_t INVALID_CODE = std::numeric_limits<std::uint64_t>::max();
+
+std::size_t chunkCount(std::size_t threads, std::size_t size)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    return std::clamp<std::size_t>(size / MIN_CHUNK_SIZE, 1, threads);
+}
+
+std::size_t chunkBegin(std::size_t chunk, std::size_t chunks, std::size_t size)
+{
+    return size * chunk / chunks;
+}
+
+// centroid(idx, out) writes a quarter of the centroid of triangle idx and returns false for invalid triangles.
+// Summed as twelfths of finite vertices, these stay finite, as do the extents of their bounds.
+template <typename T, typename Centroid>
+std::vector<std::uint64_t> computeCodes(std::size_t size, std::size_t threads, Centroid centroid)
+{
+    std::size_t chunks = chunkCount(threads, size);
+
+    struct Bounds
+    {
+        T min[3] = {inf<T>, inf<T>, inf<T>};
+        T max[3] = {-inf<T>, -inf<T>, -inf<T>};
+    };
+
+    std::vector<Bounds> chunkBounds(chunks);
+
+    runChunks(chunks, [&](std::size_t chunk)
+    {
+        Bounds& bounds = chunkBounds[chunk];
+
+        for (std::size_t idx = chunkBegin(chunk, chunks, size); idx < chunkBegin(chunk + 1, chunks, size); ++idx)
+        {
+            T center[3];
+            if (!centroid(idx, center))
+                continue;
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                bounds.min[axis] = std::min(bounds.min[axis], center[axis]);
+                bounds.max[axis] = std::max(bounds.max[axis], center[axis]);
+            }
+        }
+    });
+
+    Bounds bounds;
+    for (const Bounds& chunk : chunkBounds)
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            bounds.min[axis] = std::min(bounds.min[axis], chunk.min[axis]);
+            bounds.max[axis] = std::max(bounds.max[axis], chunk.max[axis]);
+        }
+
+    constexpr T LAST_CELL = T((1u << MORTON_BITS) - 1);
+
+    T scale[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        T extent = bounds.max[axis] - bounds.min[axis];
+        scale[axis] = (extent > 0) ? LAST_CELL / extent : T{0};
+    }
+
+    std::vector<std::uint64_t> codes(size);
+
+    runChunks(chunks, [&](std::size_t chunk)
+    {
+        for (std::size_t idx = chunkBegin(chunk, chunks, size); idx < chunkBegin(chunk + 1, chunks, size); ++idx)
+        {
+            T center[3];
+            if (!centroid(idx, center))
+            {
+                codes[idx] = INVALID_CODE;
+                continue;
+            }
+
+            // an extent too small to invert gives an infinite scale, and NaN at the minimum
+            std::uint32_t cell[3];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                T offset = (center[axis] - bounds.min[axis]) * scale[axis];
+                cell[axis] = (offset > 0) ? static_cast<std::uint32_t>(std::min(offset, LAST_CELL)) : 0;
+            }
+
+            codes[idx] = mortonCode(cell[X], cell[Y], cell[Z]);
+        }
+    });
+
+    return codes;
+}
+
+}
+
+template <typename T>
+std::vector<std::uint64_t> mortonCodes(const TriangleSoA<T>& soa, std::size_t threads)
+{
+    return computeCodes<T>(soa.size(), threads, [&](std::size_t idx, T* center)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            T sum = 0;
+            for (int vertex = 0; vertex < 3; ++vertex)
+            {
+                T coord = soa.coord(vertex, static_cast<Axis>(axis))[idx];
+                if (!floatValid(coord))
+                    return false;
+
+                sum += coord / 12;
+            }
+
+            center[axis] = sum;
+        }
+
+        return true;
+    });
+}
+
+template <typename T>
+std::vector<std::uint64_t> mortonCodes(std::span<const Triangle3D<T>> triangles, std::size_t threads)
+{
+    return computeCodes<T>(triangles.size(), threads, [&](std::size_t idx, T* center)
+    {
+        const Triangle3D<T>& tr = triangles[idx];
+        if (!tr.valid())
+            return false;
+
+        for (int axis = 0; axis < 3; ++axis)
+            center[axis] = tr[0].coords[axis] / 12 + tr[1].coords[axis] / 12 + tr[2].coords[axis] / 12;
+
+        return true;
+    });
+}
+
+// Every chunk gets its own range of positions for every digit: digits ascending, and chunks ascending within
+// a digit, which keeps the sort stable.
+std::vector<std::uint32_t> sortByCode(std::span<const std::uint64_t> codes, std::size_t threads)
+{
+    std::size_t size = codes.size();
+
+    if (size > std::size_t{std::numeric_limits<std::uint32_t>::max()} + 1)
+        throw std::length_error{"cannot sort more than 2^32 codes"};
+
+    std::vector<std::uint64_t> keys(codes.begin(), codes.end()), sortedKeys(size);
+    std::vector<std::uint32_t> order(size), sortedOrder(size);
+    std::iota(order.begin(), order.end(), 0);
+
+    std::size_t chunks = chunkCount(threads, size);
+    std::vector<std::array<std::size_t, RADIX>> positions(chunks);
+
+    for (unsigned shift = 0; shift < 64; shift += DIGIT_BITS)
+    {
+        runChunks(chunks, [&](std::size_t chunk)
+        {
+            positions[chunk].fill(0);
+
+            for (std::size_t idx = chunkBegin(chunk, chunks, size); idx < chunkBegin(chunk + 1, chunks, size); ++idx)
+                positions[chunk][(keys[idx] >> shift) & (RADIX - 1)]++;
+        });
+
+        bool shared = false;
+        std::size_t position = 0;
+
+        for (std::size_t digit = 0; digit < RADIX; ++digit)
+        {
+            std::size_t start = position;
+
+            for (auto& chunkPositions : positions)
+            {
+                std::size_t count = chunkPositions[digit];
+                chunkPositions[digit] = position;
+                position += count;
+            }
+
+            shared |= (position - start == size);
+        }
+
+        if (shared)
+            continue;
+
+        runChunks(chunks, [&](std::size_t chunk)
+        {
+            for (std::size_t idx = chunkBegin(chunk, chunks, size); idx < chunkBegin(chunk + 1, chunks, size); ++idx)
+            {
+                std::size_t pos = positions[chunk][(keys[idx] >> shift) & (RADIX - 1)]++;
+
+                sortedKeys[pos] = keys[idx];
+                sortedOrder[pos] = order[idx];
+            }
+        });
+
+        keys.swap(sortedKeys);
+        order.swap(sortedOrder);
+    }
+
+    return order;
+}
+
+template <typename T>
+std::vector<std::size_t> MortonSorted<T>::originalIndices(const std::vector<std::size_t>& sorted) const
+{
+    std::vector<std::size_t> result;
+    result.reserve(sorted.size());
+
+    for (std::size_t idx : sorted)
+        result.push_back(original[idx]);
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+template <typename T>
+MortonSorted<T> mortonSort(const TriangleSoA<T>& soa, std::size_t threads)
+{
+    MortonSorted<T> sorted;
+    sorted.original = sortByCode(mortonCodes(soa, threads), threads);
+    sorted.triangles.resize(soa.size());
+
+    std::size_t chunks = chunkCount(threads, soa.size());
+
+    runChunks(chunks, [&](std::size_t chunk)
+    {
+        for (int vertex = 0; vertex < 3; ++vertex)
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const T* from = soa.coord(vertex, static_cast<Axis>(axis));
+                T* to = sorted.triangles.coord(vertex, static_cast<Axis>(axis));
+
+                for (std::size_t idx = chunkBegin(chunk, chunks, soa.size()); idx < chunkBegin(chunk + 1, chunks, soa.size()); ++idx)
+                    to[idx] = from[sorted.original[idx]];
+            }
+    });
+
+    return sorted;
+}
+
+template std::vector<std::uint64_t> mortonCodes(const TriangleSoA<float>&, std::size_t);
+template std::vector<std::uint64_t> mortonCodes(std::span<const Triangle3D<float>>, std::size_t);
+template struct MortonSorted<float>;
+template MortonSorted<float> mortonSort(const TriangleSoA<float>&, std::size_t);
+
+template std::vector<std::uint64_t> mortonCodes(const TriangleSoA<double>&, std::size_t);
+template std::vector<std::uint64_t> mortonCodes(std::span<const Triangle3D<double>>, std::size_t);
+template struct MortonSorted<double>;
+template MortonSorted<double> mortonSort(const TriangleSoA<double>&, std::size_t);
+
+}
@@ -0,0 +1,249 @@
+#include <cmath>
+#include <limits>
+
+#include "predicates.hh"
+
+// This file is built with -ffp-contract=off: the error bounds and the exact transformations below
+// assume every product and sum is rounded on its own.
+
+namespace geometry3D
+{
+
+namespace
+{
+
+constexpr double EPSILON = std::numeric_limits<double>::epsilon() / 2;
+
+constexpr double CCW_ERRBOUND_A = (3.0 + 16.0 * EPSILON) * EPSILON;
+constexpr double O3D_ERRBOUND_A = (7.0 + 56.0 * EPSILON) * EPSILON;
+
+int sign(double value)
+{
+    return (value > 0) - (value < 0);
+}
+
+// x + y == a + b exactly, x is the rounded sum
+void twoSum(double a, double b, double& x, double& y)
+{
+    x = a + b;
+    double bVirtual = x - a;
+    double aVirtual = x - bVirtual;
+    y = (a - aVirtual) + (b - bVirtual);
+}
+
+// same as twoSum, |a| >= |b| required
+void fastTwoSum(double a, double b, double& x, double& y)
+{
+    x = a + b;
+    y = b - (x - a);
+}
+
+void twoDiff(double a, double b, double& x, double& y)
+{
+    x = a - b;
+    double bVirtual = a - x;
+    double aVirtual = x + bVirtual;
+    y = (a - aVirtual) + (bVirtual - b);
+}
+
+void twoProduct(double a, double b, double& x, double& y)
+{
+    x = a * b;
+    y = std::fma(a, b, -x);
+}
+
+// Exact sum of nonoverlapping terms sorted by increasing magnitude, zero terms are dropped.
+// The capacity is enough for the orient3d determinant of differences.
+class Expansion
+{
+    static constexpr int CAPACITY = 192;
+
+    double terms_[CAPACITY];
+    int size_ = 0;
+
+    void push(double term)
+    {
+        if (term != 0.0)
+            terms_[size_++] = term;
+    }
+
+public:
+
+    static Expansion difference(double a, double b)
+    {
+        Expansion result;
+        double x, y;
+
+        twoDiff(a, b, x, y);
+        result.push(y);
+        result.push(x);
+
+        return result;
+    }
+
+    int sign() const
+    {
+        return size_ ? geometry3D::sign(terms_[size_ - 1]) : 0;
+    }
+
+    Expansion operator- () const
+    {
+        Expansion result{*this};
+        for (int i = 0; i < size_; ++i)
+            result.terms_[i] = -terms_[i];
+
+        return result;
+    }
+
+    Expansion operator+ (const Expansion& other) const
+    {
+        Expansion result{*this};
+        for (int i = 0; i < other.size_; ++i)
+            result = result.grow(other.terms_[i]);
+
+        return result;
+    }
+
+    Expansion operator- (const Expansion& other) const
+    {
+        return *this + (-other);
+    }
+
+    Expansion operator* (const Expansion& other) const
+    {
+        Expansion result;
+        for (int i = 0; i < other.size_; ++i)
+            result = result + scale(other.terms_[i]);
+
+        return result;
+    }
+
+private:
+
+    Expansion grow(double value) const
+    {
+        Expansion result;
+        double q = value;
+
+        for (int i = 0; i < size_; ++i)
+        {
+            double sum, rest;
+            twoSum(q, terms_[i], sum, rest);
+            result.push(rest);
+            q = sum;
+        }
+        result.push(q);
+
+        return result;
+    }
+
+    Expansion scale(double value) const
+    {
+        Expansion result;
+        if (!size_)
+            return result;
+
+        double q, rest;
+        twoProduct(terms_[0], value, q, rest);
+        result.push(rest);
+
+        for (int i = 1; i < size_; ++i)
+        {
+            double high, low, sum;
+            twoProduct(terms_[i], value, high, low);
+            twoSum(q, low, sum, rest);
+            result.push(rest);
+            fastTwoSum(high, sum, q, rest);
+            result.push(rest);
+        }
+        result.push(q);
+
+        return result;
+    }
+};
+
+int orient2dExact(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    Expansion acx = Expansion::difference(ax, cx);
+    Expansion acy = Expansion::difference(ay, cy);
+    Expansion bcx = Expansion::difference(bx, cx);
+    Expansion bcy = Expansion::difference(by, cy);
+
+    return (acx * bcy - acy * bcx).sign();
+}
+
+int orient3dExact(const double* a, const double* b, const double* c, const double* d)
+{
+    Expansion adx = Expansion::difference(a[X], d[X]);
+    Expansion ady = Expansion::difference(a[Y], d[Y]);
+    Expansion adz = Expansion::difference(a[Z], d[Z]);
+    Expansion bdx = Expansion::difference(b[X], d[X]);
+    Expansion bdy = Expansion::difference(b[Y], d[Y]);
+    Expansion bdz = Expansion::difference(b[Z], d[Z]);
+    Expansion cdx = Expansion::difference(c[X], d[X]);
+    Expansion cdy = Expansion::difference(c[Y], d[Y]);
+    Expansion cdz = Expansion::difference(c[Z], d[Z]);
+
+    Expansion det = adz * (bdx * cdy - cdx * bdy) +
+                    bdz * (cdx * ady - adx * cdy) +
+                    cdz * (adx * bdy - bdx * ady);
+
+    return det.sign();
+}
+
+}
+
+int orient2d(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    double detLeft = (ax - cx) * (by - cy);
+    double detRight = (ay - cy) * (bx - cx);
+    double det = detLeft - detRight;
+
+    double detSum = 0;
+
+    if (detLeft > 0)
+    {
+        if (detRight <= 0)
+            return sign(det);
+        detSum = detLeft + detRight;
+    }
+    else if (detLeft < 0)
+    {
+        if (detRight >= 0)
+            return sign(det);
+        detSum = -detLeft - detRight;
+    }
+    else
+        return sign(det);
+
+    double errBound = CCW_ERRBOUND_A * detSum;
+    if (det >= errBound || -det >= errBound)
+        return sign(det);
+
+    return orient2dExact(ax, ay, bx, by, cx, cy);
+}
+
+int orient3d(const double* a, const double* b, const double* c, const double* d)
+{
+    double adx = a[X] - d[X], ady = a[Y] - d[Y], adz = a[Z] - d[Z];
+    double bdx = b[X] - d[X], bdy = b[Y] - d[Y], bdz = b[Z] - d[Z];
+    double cdx = c[X] - d[X], cdy = c[Y] - d[Y], cdz = c[Z] - d[Z];
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+
+    double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(adz) +
+                       (std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bdz) +
+                       (std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cdz);
+
+    double errBound = O3D_ERRBOUND_A * permanent;
+    if (det > errBound || -det > errBound)
+        return sign(det);
+
+    return orient3dExact(a, b, c, d);
+}
+
+}
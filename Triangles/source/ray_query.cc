@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ray_query.hh"
+#include "soa_kernels.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+template <typename T>
+T dot(const T* lhs, const T* rhs)
+{
+    return lhs[X] * rhs[X] + lhs[Y] * rhs[Y] + lhs[Z] * rhs[Z];
+}
+
+template <typename T>
+void cross(const T* lhs, const T* rhs, T* out)
+{
+    out[X] = lhs[Y] * rhs[Z] - lhs[Z] * rhs[Y];
+    out[Y] = lhs[Z] * rhs[X] - lhs[X] * rhs[Z];
+    out[Z] = lhs[X] * rhs[Y] - lhs[Y] * rhs[X];
+}
+
+// the same steps as the packet kernels, though not summed in the same order, so single rays and packets agree
+// on hits within rounding
+template <typename T>
+RayHit<T> mollerTrumbore(const Ray3D<T>& ray, const T* vertex, const T* edge1, const T* edge2)
+{
+    const T* origin = ray.origin.coords.data();
+    const T* direction = ray.direction.coords.data();
+
+    T tvec[3] = {origin[X] - vertex[X], origin[Y] - vertex[Y], origin[Z] - vertex[Z]};
+
+    T pvec[3], qvec[3];
+    cross(direction, edge2, pvec);
+    cross(tvec, edge1, qvec);
+
+    T det = dot(edge1, pvec);
+    T invDet = 1 / det;
+
+    T u = dot(tvec, pvec) * invDet;
+    T v = dot(direction, qvec) * invDet;
+    T t = dot(edge2, qvec) * invDet;
+
+    if (!(std::abs(det) > 0) || !(u >= 0) || !(v >= 0) || !(u + v <= 1) || !(t >= ray.tMin) || !(t < ray.tMax))
+        return RayHit<T>{};
+
+    return RayHit<T>{t, u, v};
+}
+
+// Depth-first descent into the boxes the ray's interval reaches, nearer child first.
+// visit(idx, tMax) is called for the triangles of the reached leaves and may shrink tMax; true stops the traversal.
+template <typename T, typename Visit>
+void traverse(const BVH<T>& bvh, const Ray3D<T>& ray, Visit visit)
+{
+    if (bvh.empty() || !ray.valid())
+        return;
+
+    // zero direction components would make the slab test compute 0 * inf
+    constexpr T TINY = T(1e-20);
+
+    T invDirection[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        T dir = ray.direction.coords[axis];
+        invDirection[axis] = 1 / (std::abs(dir) < TINY ? std::copysign(TINY, dir) : dir);
+    }
+
+    T tMax = ray.tMax;
+    const std::vector<BVHNode<T>>& nodes = bvh.nodes();
+
+    auto entry = [&](const BVHNode<T>& node)
+    {
+        T near = ray.tMin, far = tMax;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            T t0 = (node.min[axis] - ray.origin.coords[axis]) * invDirection[axis];
+            T t1 = (node.max[axis] - ray.origin.coords[axis]) * invDirection[axis];
+
+            near = std::max(near, std::min(t0, t1));
+            far = std::min(far, std::max(t0, t1));
+        }
+
+        return (near <= far) ? near : inf<T>;
+    };
+
+    std::uint32_t stack[2 * BVH<T>::MAX_DEPTH];
+    std::size_t size = 0;
+
+    if (entry(nodes[0]) != inf<T>)
+        stack[size++] = 0;
+
+    while (size)
+    {
+        const BVHNode<T>& node = nodes[stack[--size]];
+
+        if (node.leaf())
+        {
+            for (std::uint32_t idx = node.first; idx < node.first + node.count; ++idx)
+                if (visit(idx, tMax))
+                    return;
+
+            continue;
+        }
+
+        T left = entry(nodes[node.first]);
+        T right = entry(nodes[node.first + 1]);
+
+        std::uint32_t nearer = (left <= right) ? node.first : node.first + 1;
+        std::uint32_t farther = (left <= right) ? node.first + 1 : node.first;
+
+        if (std::max(left, right) != inf<T>)
+            stack[size++] = farther;
+        if (std::min(left, right) != inf<T>)
+            stack[size++] = nearer;
+    }
+}
+
+template <typename T>
+kernels::RaySceneView<T> makeView(const RayScene<T>& scene)
+{
+    kernels::RaySceneView<T> view;
+
+    view.nodes = scene.bvh().nodes().data();
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        view.vertex[axis] = scene.vertex(static_cast<Axis>(axis));
+        view.edge1[axis] = scene.edge1(static_cast<Axis>(axis));
+        view.edge2[axis] = scene.edge2(static_cast<Axis>(axis));
+    }
+    view.ids = scene.ids();
+
+    return view;
+}
+
+}
+
+template <typename T>
+RayHit<T> rayTriangleIntersect(const Ray3D<T>& ray, const Triangle3D<T>& tr)
+{
+    if (!ray.valid())
+        return RayHit<T>{};
+
+    T edge1[3], edge2[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        edge1[axis] = tr[1].coords[axis] - tr[0].coords[axis];
+        edge2[axis] = tr[2].coords[axis] - tr[0].coords[axis];
+    }
+
+    return mollerTrumbore(ray, tr[0].coords.data(), edge1, edge2);
+}
+
+template <typename T>
+RayScene<T>::RayScene(std::span<const Triangle3D<T>> triangles)
+{
+    std::vector<std::size_t> valid;
+    std::vector<AABB3D<T>> boxes;
+
+    for (std::size_t idx = 0; idx < triangles.size(); ++idx)
+    {
+        const Triangle3D<T>& tr = triangles[idx];
+        if (!tr.valid())
+            continue;
+
+        valid.push_back(idx);
+        boxes.push_back(tr.box());
+    }
+
+    bvh_.build(boxes);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        vertex_[axis].resize(valid.size());
+        edge1_[axis].resize(valid.size());
+        edge2_[axis].resize(valid.size());
+    }
+    ids_.resize(valid.size());
+
+    for (std::size_t pos = 0; pos < valid.size(); ++pos)
+    {
+        std::size_t id = valid[bvh_.order()[pos]];
+        const Triangle3D<T>& tr = triangles[id];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            vertex_[axis][pos] = tr[0].coords[axis];
+            edge1_[axis][pos] = tr[1].coords[axis] - tr[0].coords[axis];
+            edge2_[axis][pos] = tr[2].coords[axis] - tr[0].coords[axis];
+        }
+        ids_[pos] = id;
+    }
+}
+
+template <typename T>
+RayHit<T> RayScene<T>::closestHit(const Ray3D<T>& ray) const
+{
+    RayHit<T> closest;
+
+    traverse(bvh_, ray, [&](std::uint32_t idx, T& tMax)
+    {
+        T vertex[3] = {vertex_[X][idx], vertex_[Y][idx], vertex_[Z][idx]};
+        T edge1[3] = {edge1_[X][idx], edge1_[Y][idx], edge1_[Z][idx]};
+        T edge2[3] = {edge2_[X][idx], edge2_[Y][idx], edge2_[Z][idx]};
+
+        Ray3D<T> clipped{ray.origin, ray.direction, ray.tMin, tMax};
+        RayHit<T> hit = mollerTrumbore(clipped, vertex, edge1, edge2);
+
+        if (hit.valid())
+        {
+            closest = hit;
+            closest.triangle = ids_[idx];
+            tMax = hit.t;
+        }
+
+        return false;
+    });
+
+    return closest;
+}
+
+template <typename T>
+bool RayScene<T>::anyHit(const Ray3D<T>& ray) const
+{
+    bool found = false;
+
+    traverse(bvh_, ray, [&](std::uint32_t idx, T&)
+    {
+        T vertex[3] = {vertex_[X][idx], vertex_[Y][idx], vertex_[Z][idx]};
+        T edge1[3] = {edge1_[X][idx], edge1_[Y][idx], edge1_[Z][idx]};
+        T edge2[3] = {edge2_[X][idx], edge2_[Y][idx], edge2_[Z][idx]};
+
+        found = mollerTrumbore(ray, vertex, edge1, edge2).valid();
+        return found;
+    });
+
+    return found;
+}
+
+template <typename T>
+std::vector<RayHit<T>> RayScene<T>::allHits(const Ray3D<T>& ray) const
+{
+    std::vector<RayHit<T>> hits;
+
+    traverse(bvh_, ray, [&](std::uint32_t idx, T&)
+    {
+        T vertex[3] = {vertex_[X][idx], vertex_[Y][idx], vertex_[Z][idx]};
+        T edge1[3] = {edge1_[X][idx], edge1_[Y][idx], edge1_[Z][idx]};
+        T edge2[3] = {edge2_[X][idx], edge2_[Y][idx], edge2_[Z][idx]};
+
+        RayHit<T> hit = mollerTrumbore(ray, vertex, edge1, edge2);
+        if (hit.valid())
+        {
+            hit.triangle = ids_[idx];
+            hits.push_back(hit);
+        }
+
+        return false;
+    });
+
+    std::sort(hits.begin(), hits.end(), [](const RayHit<T>& lhs, const RayHit<T>& rhs)
+    {
+        return (lhs.t != rhs.t) ? lhs.t < rhs.t : lhs.triangle < rhs.triangle;
+    });
+
+    return hits;
+}
+
+template <typename T>
+void RayScene<T>::closestHit(std::span<const Ray3D<T>> rays, std::span<RayHit<T>> out) const
+{
+    if (empty())
+    {
+        std::fill_n(out.begin(), rays.size(), RayHit<T>{});
+        return;
+    }
+
+    kernels::activeKernels<T>().closestHit(makeView(*this), rays.data(), rays.size(), out.data());
+}
+
+template <typename T>
+void RayScene<T>::anyHit(std::span<const Ray3D<T>> rays, std::span<std::uint8_t> out) const
+{
+    if (empty())
+    {
+        std::fill_n(out.begin(), rays.size(), 0);
+        return;
+    }
+
+    kernels::activeKernels<T>().anyHit(makeView(*this), rays.data(), rays.size(), out.data());
+}
+
+template RayHit<float> rayTriangleIntersect(const Ray3D<float>&, const Triangle3D<float>&);
+template RayHit<double> rayTriangleIntersect(const Ray3D<double>&, const Triangle3D<double>&);
+
+template class RayScene<float>;
+template class RayScene<double>;
+
+}
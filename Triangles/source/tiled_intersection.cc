@@ -0,0 +1,640 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bvh.hh"
+#include "morton.hh"
+#include "tiled_intersection.hh"
+#include "triangle_io.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+// the centroids are sorted into 64 x 64 x 64 cells before they are grouped into tiles
+constexpr unsigned GRID_BITS = 6;
+constexpr std::size_t CELL_COUNT = std::size_t{1} << (3 * GRID_BITS);
+
+// a tile takes at most this share of the budget, the rest keeps the tiles tested against it
+constexpr std::size_t TILE_SHARE = 8;
+
+// triangles read from the input or a tile at once
+constexpr std::size_t BLOCK_SIZE = 1 << 14;
+constexpr std::size_t MAX_BUFFER_BYTES = 1 << 20;
+
+template <typename T>
+struct Record
+{
+    std::uint64_t id;
+    T coords[9];
+};
+
+// memory a triangle takes while its tile is tested: the triangle with its cached box, its id and the search
+// structure over the tile
+template <typename T>
+constexpr std::size_t RESIDENT_BYTES = sizeof(Triangle3D<T>) + sizeof(std::uint64_t) + sizeof(AABB3D<T>) +
+                                       sizeof(std::uint32_t) + sizeof(BVHNode<T>);
+
+// memory a triangle takes while its tile is sorted: its record and code, then either its coordinates for the
+// code or the keys and indices of the radix sort
+template <typename T>
+constexpr std::size_t SORT_BYTES = sizeof(Record<T>) + sizeof(std::uint64_t) +
+                                   std::max(9 * sizeof(T), 2 * sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t));
+
+// A file nobody else sees: it is unlinked as soon as it is created and disappears when closed.
+class ScratchFile
+{
+    int fd_;
+
+public:
+
+    explicit ScratchFile(const std::string& directory)
+    {
+        std::string path = (directory.empty() ? std::filesystem::temp_directory_path().string() : directory) +
+                           "/triangles-XXXXXX";
+
+        fd_ = ::mkstemp(path.data());
+        if (fd_ < 0)
+            throw std::system_error{errno, std::generic_category(), "cannot create scratch file " + path};
+
+        ::unlink(path.c_str());
+    }
+
+    ScratchFile(const ScratchFile&) = delete;
+    ScratchFile& operator= (const ScratchFile&) = delete;
+
+    ~ScratchFile()
+    {
+        ::close(fd_);
+    }
+
+    void write(const void* data, std::size_t bytes, std::uint64_t offset) const
+    {
+        const char* pos = static_cast<const char*>(data);
+
+        while (bytes != 0)
+        {
+            ssize_t done = ::pwrite(fd_, pos, bytes, static_cast<off_t>(offset));
+            if (done < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                throw std::system_error{errno, std::generic_category(), "cannot write scratch file"};
+            }
+
+            pos += done;
+            bytes -= static_cast<std::size_t>(done);
+            offset += static_cast<std::uint64_t>(done);
+        }
+    }
+
+    void read(void* data, std::size_t bytes, std::uint64_t offset) const
+    {
+        char* pos = static_cast<char*>(data);
+
+        while (bytes != 0)
+        {
+            ssize_t done = ::pread(fd_, pos, bytes, static_cast<off_t>(offset));
+            if (done <= 0)
+            {
+                if (done < 0 && errno == EINTR)
+                    continue;
+
+                throw std::system_error{done < 0 ? errno : EIO, std::generic_category(), "cannot read scratch file"};
+            }
+
+            pos += done;
+            bytes -= static_cast<std::size_t>(done);
+            offset += static_cast<std::uint64_t>(done);
+        }
+    }
+};
+
+template <typename T>
+Triangle3D<T> makeTriangle(const T* coords)
+{
+    return Triangle3D<T>{{coords[0], coords[1], coords[2]}, {coords[3], coords[4], coords[5]},
+                         {coords[6], coords[7], coords[8]}};
+}
+
+// Text input is parsed once into a scratch file of 9 coordinates per triangle, which is then read as often as needed.
+template <typename T>
+class RawTriangles
+{
+    ScratchFile file_;
+    std::size_t size_ = 0;
+
+public:
+
+    RawTriangles(const std::string& path, const std::string& directory) : file_(directory)
+    {
+        MappedFile text{path};
+        TriangleTextReader<T> reader{text.view()};
+
+        std::vector<T> block;
+        block.reserve(9 * BLOCK_SIZE);
+
+        std::size_t parsed = 0;
+
+        auto flush = [&]
+        {
+            file_.write(block.data(), block.size() * sizeof(T), (size_ - block.size() / 9) * 9 * sizeof(T));
+            block.clear();
+
+            text.release(parsed, reader.offset() - parsed);
+            parsed = reader.offset();
+        };
+
+        for (Triangle3D<T> tr{{}, {}, {}}; reader.next(tr);)
+        {
+            for (int vertex = 0; vertex < 3; ++vertex)
+                block.insert(block.end(), tr[vertex].coords.begin(), tr[vertex].coords.end());
+
+            ++size_;
+            if (block.size() == 9 * BLOCK_SIZE)
+                flush();
+        }
+
+        flush();
+    }
+
+    std::size_t size() const { return size_; }
+
+    template <typename Visit>
+    void forEach(Visit visit) const
+    {
+        std::vector<T> block(9 * BLOCK_SIZE);
+
+        for (std::size_t first = 0; first < size_; first += BLOCK_SIZE)
+        {
+            std::size_t count = std::min(BLOCK_SIZE, size_ - first);
+            file_.read(block.data(), 9 * count * sizeof(T), 9 * first * sizeof(T));
+
+            for (std::size_t idx = 0; idx < count; ++idx)
+                visit(first + idx, makeTriangle(block.data() + 9 * idx));
+        }
+    }
+};
+
+// binary STL is read straight from the mapping, which is released behind the reading
+template <typename T>
+class StlTriangles
+{
+    MappedFile file_;
+    StlView stl_;
+
+public:
+
+    explicit StlTriangles(const std::string& path) : file_(path), stl_(file_.view())
+    {}
+
+    std::size_t size() const { return stl_.size(); }
+
+    template <typename Visit>
+    void forEach(Visit visit) const
+    {
+        for (std::size_t idx = 0; idx < stl_.size(); ++idx)
+        {
+            T coords[9];
+            for (int vertex = 0; vertex < 3; ++vertex)
+            {
+                Point3D<float> point = stl_.point(idx, vertex);
+
+                for (int axis = 0; axis < 3; ++axis)
+                    coords[3 * vertex + axis] = point.coords[axis];
+            }
+
+            visit(idx, makeTriangle(coords));
+
+            if ((idx + 1) % BLOCK_SIZE == 0 || idx + 1 == stl_.size())
+            {
+                std::size_t first = (idx / BLOCK_SIZE) * BLOCK_SIZE;
+                file_.release(StlView::HEADER_SIZE + first * StlView::RECORD_SIZE,
+                              (idx + 1 - first) * StlView::RECORD_SIZE);
+            }
+        }
+    }
+};
+
+template <typename T>
+AABB3D<T> emptyBox()
+{
+    return AABB3D<T>{{inf<T>, inf<T>, inf<T>}, {-inf<T>, -inf<T>, -inf<T>}};
+}
+
+template <typename T>
+void extend(AABB3D<T>& box, const AABB3D<T>& other)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        box.min.coords[axis] = std::min(box.min.coords[axis], other.min.coords[axis]);
+        box.max.coords[axis] = std::max(box.max.coords[axis], other.max.coords[axis]);
+    }
+}
+
+// a quarter of the centroid, which stays finite for finite vertices, as do the extents of the bounds of such points
+template <typename T>
+Point3D<T> quarterCentroid(const Triangle3D<T>& tr)
+{
+    Point3D<T> result;
+    for (int axis = 0; axis < 3; ++axis)
+        result.coords[axis] = tr[0].coords[axis] / 12 + tr[1].coords[axis] / 12 + tr[2].coords[axis] / 12;
+
+    return result;
+}
+
+// Morton index of the cell holding a point of the bounds
+template <typename T>
+class Grid
+{
+    AABB3D<T> bounds_;
+    T scale_[3];
+
+public:
+
+    explicit Grid(const AABB3D<T>& bounds) : bounds_(bounds)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            T extent = bounds.max.coords[axis] - bounds.min.coords[axis];
+            scale_[axis] = (extent > 0) ? T((1 << GRID_BITS)) / extent : T{0};
+        }
+    }
+
+    std::size_t cell(const Point3D<T>& point) const
+    {
+        std::uint32_t cell[3];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            // an extent too small to invert gives an infinite scale, and NaN at the minimum
+            T offset = (point.coords[axis] - bounds_.min.coords[axis]) * scale_[axis];
+            cell[axis] = (offset > 0) ? static_cast<std::uint32_t>(std::min(offset, T((1 << GRID_BITS) - 1))) : 0;
+        }
+
+        return mortonCode(cell[X], cell[Y], cell[Z]);
+    }
+};
+
+// triangles of the tile are records [first, first + count) of the tile file
+template <typename T>
+struct Tile
+{
+    std::uint64_t first = 0;
+    std::uint64_t count = 0;
+    AABB3D<T> bounds = emptyBox<T>();
+};
+
+template <typename T>
+struct LoadedTile
+{
+    std::vector<std::uint64_t> ids;
+    std::vector<Triangle3D<T>> triangles;
+};
+
+// Tiles read lately, the least recently used ones are dropped once they hold more triangles than the capacity.
+// A tile read for the first time is sorted before it is read, so the sort has the room the tile takes afterwards.
+template <typename T>
+class TileCache
+{
+    const ScratchFile& file_;
+    const std::vector<Tile<T>>& tiles_;
+    std::size_t capacity_;
+    std::size_t cached_ = 0;
+    std::vector<bool> sorted_;
+
+    // most recently used last
+    std::vector<std::pair<std::size_t, std::shared_ptr<const LoadedTile<T>>>> entries_;
+
+public:
+
+    TileCache(const ScratchFile& file, const std::vector<Tile<T>>& tiles, std::size_t capacity) :
+        file_(file), tiles_(tiles), capacity_(capacity), sorted_(tiles.size(), false)
+    {}
+
+    std::shared_ptr<const LoadedTile<T>> get(std::size_t tile)
+    {
+        auto found = std::find_if(entries_.begin(), entries_.end(), [&](const auto& entry)
+        {
+            return entry.first == tile;
+        });
+
+        if (found != entries_.end())
+        {
+            std::rotate(found, found + 1, entries_.end());
+            return entries_.back().second;
+        }
+
+        std::size_t count = tiles_[tile].count;
+        std::size_t needed = sorted_[tile] ? count : std::max(count, sortScratch(count));
+
+        while (!entries_.empty() && cached_ + needed > capacity_)
+        {
+            cached_ -= entries_.front().second->triangles.size();
+            entries_.erase(entries_.begin());
+        }
+
+        entries_.emplace_back(tile, load(tile));
+        cached_ += count;
+
+        return entries_.back().second;
+    }
+
+private:
+
+    // the sort's memory in triangles of the capacity
+    static std::size_t sortScratch(std::size_t count)
+    {
+        return (count * SORT_BYTES<T> + RESIDENT_BYTES<T> - 1) / RESIDENT_BYTES<T>;
+    }
+
+    std::shared_ptr<const LoadedTile<T>> load(std::size_t tile)
+    {
+        if (!sorted_[tile])
+            sort(tile);
+
+        auto loaded = std::make_shared<LoadedTile<T>>();
+
+        std::size_t count = tiles_[tile].count;
+        loaded->ids.reserve(count);
+        loaded->triangles.reserve(count);
+
+        std::vector<Record<T>> block(std::min(count, BLOCK_SIZE));
+
+        for (std::size_t first = 0; first < count; first += BLOCK_SIZE)
+        {
+            std::size_t size = std::min(BLOCK_SIZE, count - first);
+            file_.read(block.data(), size * sizeof(Record<T>), (tiles_[tile].first + first) * sizeof(Record<T>));
+
+            for (std::size_t idx = 0; idx < size; ++idx)
+            {
+                loaded->ids.push_back(block[idx].id);
+                loaded->triangles.push_back(makeTriangle(block[idx].coords));
+            }
+        }
+
+        return loaded;
+    }
+
+    // Tiles are written in input order. Sorting a tile into Morton order when it is first needed puts the
+    // triangles a query reaches close to each other in memory for all its uses.
+    void sort(std::size_t tile)
+    {
+        std::size_t count = tiles_[tile].count;
+        std::uint64_t offset = tiles_[tile].first * sizeof(Record<T>);
+
+        std::vector<Record<T>> records(count);
+        file_.read(records.data(), count * sizeof(Record<T>), offset);
+
+        std::vector<std::uint32_t> order;
+        {
+            std::vector<std::uint64_t> codes;
+            {
+                TriangleSoA<T> soa;
+                soa.resize(count);
+                for (std::size_t idx = 0; idx < count; ++idx)
+                    for (int vertex = 0; vertex < 3; ++vertex)
+                        for (int axis = 0; axis < 3; ++axis)
+                            soa.coord(vertex, static_cast<Axis>(axis))[idx] = records[idx].coords[3 * vertex + axis];
+
+                codes = mortonCodes(soa);
+            }
+
+            order = sortByCode(codes);
+        }
+
+        // the records are permuted in place along the cycles of order, every placed record marks its slot done
+        for (std::size_t start = 0; start < count; ++start)
+        {
+            if (order[start] == start)
+                continue;
+
+            Record<T> first = records[start];
+            std::size_t pos = start;
+
+            while (order[pos] != start)
+            {
+                std::size_t next = order[pos];
+                records[pos] = records[next];
+                order[pos] = static_cast<std::uint32_t>(pos);
+                pos = next;
+            }
+
+            records[pos] = first;
+            order[pos] = static_cast<std::uint32_t>(pos);
+        }
+
+        file_.write(records.data(), count * sizeof(Record<T>), offset);
+        sorted_[tile] = true;
+    }
+};
+
+// calls visit(idx) for the boxes overlapping the given one, with the tolerance of AABB3D::overlaps
+template <typename T, typename Visit>
+void overlapping(const BVH<T>& bvh, const AABB3D<T>& box, Visit visit)
+{
+    if (bvh.empty())
+        return;
+
+    std::uint32_t stack[2 * BVH<T>::MAX_DEPTH];
+    std::size_t top = 0;
+    stack[top++] = 0;
+
+    while (top != 0)
+    {
+        const BVHNode<T>& node = bvh.nodes()[stack[--top]];
+
+        bool disjoint = false;
+        for (int axis = 0; axis < 3; ++axis)
+            disjoint |= node.min[axis] > box.max.coords[axis] + EPS<T> || box.min.coords[axis] > node.max[axis] + EPS<T>;
+
+        if (disjoint)
+            continue;
+
+        if (node.leaf())
+        {
+            for (std::uint32_t idx = node.first; idx < node.first + node.count; ++idx)
+                visit(bvh.order()[idx]);
+        }
+        else
+        {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+        }
+    }
+}
+
+// Three passes over the input: bounds of the centroids, the number of centroids in every grid cell, which gives
+// the tiles and their places in the tile file, and the copy of every triangle into its tile. Then every tile is
+// tested against itself and the following tiles its bounds overlap, through a hierarchy over its own boxes.
+template <typename T, typename Source>
+std::vector<bool> intersectTiled(const Source& source, const TilingOptions& options)
+{
+    std::size_t size = source.size();
+    std::vector<bool> intersecting(size, false);
+
+    // the result and the grid are kept all the time
+    std::size_t reserved = size / 8 + CELL_COUNT * (sizeof(std::uint64_t) + sizeof(std::uint32_t));
+    std::size_t usable = (options.memoryBudget > reserved) ? options.memoryBudget - reserved : 0;
+    std::size_t tileCapacity = std::max<std::size_t>(1, usable / (TILE_SHARE * RESIDENT_BYTES<T>));
+
+    AABB3D<T> centroidBounds = emptyBox<T>();
+    source.forEach([&](std::size_t, const Triangle3D<T>& tr)
+    {
+        if (tr.valid())
+        {
+            Point3D<T> center = quarterCentroid(tr);
+            extend(centroidBounds, AABB3D<T>{center, center});
+        }
+    });
+
+    if (centroidBounds.min.coords[X] > centroidBounds.max.coords[X])
+        return intersecting;
+
+    Grid<T> grid{centroidBounds};
+
+    std::vector<std::uint64_t> cellCounts(CELL_COUNT, 0);
+    source.forEach([&](std::size_t, const Triangle3D<T>& tr)
+    {
+        if (tr.valid())
+            ++cellCounts[grid.cell(quarterCentroid(tr))];
+    });
+
+    // consecutive cells in Morton order are close to each other, so runs of them make compact tiles
+    std::vector<std::uint32_t> cellTiles(CELL_COUNT);
+    std::vector<Tile<T>> tiles(1);
+
+    for (std::size_t cell = 0; cell < CELL_COUNT; ++cell)
+    {
+        if (tiles.back().count != 0 && tiles.back().count + cellCounts[cell] > tileCapacity)
+            tiles.push_back(Tile<T>{tiles.back().first + tiles.back().count});
+
+        cellTiles[cell] = static_cast<std::uint32_t>(tiles.size() - 1);
+        tiles.back().count += cellCounts[cell];
+    }
+
+    ScratchFile tileFile{options.scratchDirectory};
+
+    {
+        std::size_t bufferSize = std::clamp<std::size_t>(usable / 2 / tiles.size() / sizeof(Record<T>), 1,
+                                                         MAX_BUFFER_BYTES / sizeof(Record<T>));
+
+        std::vector<std::vector<Record<T>>> buffers(tiles.size());
+        std::vector<std::uint64_t> written(tiles.size(), 0);
+
+        auto flush = [&](std::size_t tile)
+        {
+            std::vector<Record<T>>& buffer = buffers[tile];
+
+            tileFile.write(buffer.data(), buffer.size() * sizeof(Record<T>),
+                           (tiles[tile].first + written[tile]) * sizeof(Record<T>));
+            written[tile] += buffer.size();
+            buffer.clear();
+        };
+
+        source.forEach([&](std::size_t id, const Triangle3D<T>& tr)
+        {
+            if (!tr.valid())
+                return;
+
+            std::size_t tile = cellTiles[grid.cell(quarterCentroid(tr))];
+            extend(tiles[tile].bounds, tr.box());
+
+            Record<T> record{id, {}};
+            for (int vertex = 0; vertex < 3; ++vertex)
+                for (int axis = 0; axis < 3; ++axis)
+                    record.coords[3 * vertex + axis] = tr[vertex].coords[axis];
+
+            buffers[tile].push_back(record);
+            if (buffers[tile].size() == bufferSize)
+                flush(tile);
+        });
+
+        for (std::size_t tile = 0; tile < tiles.size(); ++tile)
+            flush(tile);
+    }
+
+    TileCache<T> cache{tileFile, tiles, (TILE_SHARE - 1) * tileCapacity};
+
+    std::vector<AABB3D<T>> boxes;
+    BVH<T> bvh;
+
+    for (std::size_t anchor = 0; anchor < tiles.size(); ++anchor)
+    {
+        if (tiles[anchor].count == 0)
+            continue;
+
+        std::shared_ptr<const LoadedTile<T>> tile = cache.get(anchor);
+        const std::vector<Triangle3D<T>>& triangles = tile->triangles;
+
+        boxes.clear();
+        for (const Triangle3D<T>& tr : triangles)
+            boxes.push_back(tr.box());
+        bvh.build(boxes);
+
+        auto test = [&](std::uint64_t lhsId, const Triangle3D<T>& lhs, std::size_t rhs)
+        {
+            std::uint64_t rhsId = tile->ids[rhs];
+
+            if (intersecting[lhsId] && intersecting[rhsId])
+                return;
+
+            if (triangleTriangleIntersect(lhs, triangles[rhs]))
+                intersecting[lhsId] = intersecting[rhsId] = true;
+        };
+
+        for (std::size_t idx = 0; idx < triangles.size(); ++idx)
+            overlapping(bvh, boxes[idx], [&](std::size_t other)
+            {
+                if (other > idx)
+                    test(tile->ids[idx], triangles[idx], other);
+            });
+
+        for (std::size_t partner = anchor + 1; partner < tiles.size(); ++partner)
+        {
+            if (tiles[partner].count == 0 || !tiles[partner].bounds.overlaps(tiles[anchor].bounds))
+                continue;
+
+            std::shared_ptr<const LoadedTile<T>> partnerTile = cache.get(partner);
+
+            for (std::size_t idx = 0; idx < partnerTile->triangles.size(); ++idx)
+            {
+                const Triangle3D<T>& tr = partnerTile->triangles[idx];
+
+                if (tr.box().overlaps(tiles[anchor].bounds))
+                    overlapping(bvh, tr.box(), [&](std::size_t other)
+                    {
+                        test(partnerTile->ids[idx], tr, other);
+                    });
+            }
+        }
+    }
+
+    return intersecting;
+}
+
+}
+
+template <typename T>
+std::vector<bool> intersectingTrianglesOutOfCore(const std::string& path, const TilingOptions& options)
+{
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".stl") == 0)
+        return intersectTiled<T>(StlTriangles<T>{path}, options);
+
+    return intersectTiled<T>(RawTriangles<T>{path, options.scratchDirectory}, options);
+}
+
+template std::vector<bool> intersectingTrianglesOutOfCore<float>(const std::string&, const TilingOptions&);
+template std::vector<bool> intersectingTrianglesOutOfCore<double>(const std::string&, const TilingOptions&);
+
+}
@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <numeric>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parallel.hh"
+#include "triangle_io.hh"
+
+static_assert(std::endian::native == std::endian::little, "binary STL is read without byte swapping");
+
+namespace geometry3D
+{
+
+namespace
+{
+
+// smaller inputs are not worth a thread
+constexpr std::size_t MIN_CHUNK_BYTES = 1 << 20;
+
+std::size_t chunkCount(std::size_t chunks, std::size_t bytes)
+{
+    if (chunks != 0)
+        return chunks;
+
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<std::size_t>(bytes / MIN_CHUNK_BYTES, 1, threads);
+}
+
+bool space(char symbol)
+{
+    return symbol == ' ' || symbol == '\n' || symbol == '\t' || symbol == '\r' || symbol == '\v' || symbol == '\f';
+}
+
+const char* skipSpace(const char* pos, const char* end)
+{
+    while (pos != end && space(*pos))
+        ++pos;
+
+    return pos;
+}
+
+std::size_t countTokens(const char* pos, const char* end)
+{
+    std::size_t count = 0;
+    bool inToken = false;
+
+    for (; pos != end; ++pos)
+    {
+        bool separator = space(*pos);
+        count += !separator && !inToken;
+        inToken = !separator;
+    }
+
+    return count;
+}
+
+[[noreturn]] void malformed(std::string_view text, const char* pos, const std::string& what)
+{
+    throw std::runtime_error{what + " at offset " + std::to_string(pos - text.data())};
+}
+
+// the number has to be followed by whitespace or the end
+template <typename Number>
+const char* parseNumber(std::string_view text, const char* pos, const char* end, Number& value, const char* what)
+{
+    const char* start = (*pos == '+') ? pos + 1 : pos;
+
+    auto [next, error] = std::from_chars(start, end, value);
+    if (error != std::errc{} || (next != end && !space(*next)))
+        malformed(text, pos, what);
+
+    return next;
+}
+
+}
+
+MappedFile::MappedFile(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::system_error{errno, std::generic_category(), "cannot open " + path};
+
+    struct stat info;
+    if (::fstat(fd, &info) < 0)
+    {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error{error, std::generic_category(), "cannot stat " + path};
+    }
+
+    size_ = static_cast<std::size_t>(info.st_size);
+
+    if (size_ != 0)
+    {
+        void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "cannot map " + path};
+        }
+
+        // chunks are parsed in parallel, so the whole file is wanted at once rather than sequentially
+        ::madvise(mapping, size_, MADV_WILLNEED);
+        data_ = static_cast<const char*>(mapping);
+    }
+
+    ::close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+{}
+
+MappedFile& MappedFile::operator= (MappedFile&& other) noexcept
+{
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        ::munmap(const_cast<char*>(data_), size_);
+}
+
+void MappedFile::release(std::size_t offset, std::size_t size) const
+{
+    std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+    std::size_t begin = (offset + page - 1) / page * page;
+    std::size_t end = std::min(offset + size, size_) / page * page;
+
+    if (begin < end)
+        ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+}
+
+// Two passes over the chunks: the first counts the numbers in every chunk, which gives each chunk the index
+// of its first coordinate, the second parses them straight into their places.
+template <typename T>
+TriangleSoA<T> parseTriangles(std::string_view text, std::size_t chunks)
+{
+    const char* end = text.data() + text.size();
+    const char* pos = skipSpace(text.data(), end);
+
+    if (pos == end)
+        malformed(text, pos, "missing triangle count");
+
+    std::size_t count;
+    const char* body = parseNumber(text, pos, end, count, "invalid triangle count");
+
+    chunks = chunkCount(chunks, static_cast<std::size_t>(end - body));
+
+    // borders are moved forward to whitespace so no number is split between chunks
+    std::vector<const char*> borders(chunks + 1);
+    borders[0] = body;
+    borders[chunks] = end;
+
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+        const char* border = std::max(body + (end - body) * chunk / chunks, borders[chunk - 1]);
+        while (border != end && !space(*border))
+            ++border;
+
+        borders[chunk] = border;
+    }
+
+    std::vector<std::size_t> firstNumber(chunks + 1, 0);
+    runChunks(chunks, [&](std::size_t chunk)
+    {
+        firstNumber[chunk + 1] = countTokens(borders[chunk], borders[chunk + 1]);
+    });
+    std::partial_sum(firstNumber.begin(), firstNumber.end(), firstNumber.begin());
+
+    if (firstNumber[chunks] != 9 * count)
+        malformed(text, end, "expected " + std::to_string(9 * count) + " coordinates, found " +
+                             std::to_string(firstNumber[chunks]));
+
+    TriangleSoA<T> soa;
+    soa.resize(count);
+
+    // number i is coordinate i % 3 of vertex i / 3 % 3 of triangle i / 9
+    T* coords[9];
+    for (int vertex = 0; vertex < 3; ++vertex)
+        for (int axis = 0; axis < 3; ++axis)
+            coords[3 * vertex + axis] = soa.coord(vertex, static_cast<Axis>(axis));
+
+    runChunks(chunks, [&](std::size_t chunk)
+    {
+        std::size_t number = firstNumber[chunk];
+        const char* chunkEnd = borders[chunk + 1];
+
+        for (const char* pos = skipSpace(borders[chunk], chunkEnd); pos != chunkEnd; pos = skipSpace(pos, chunkEnd))
+        {
+            T value;
+            pos = parseNumber(text, pos, chunkEnd, value, "invalid coordinate");
+
+            coords[number % 9][number / 9] = value;
+            ++number;
+        }
+    });
+
+    return soa;
+}
+
+template <typename T>
+TriangleSoA<T> loadTriangles(const std::string& path, std::size_t chunks)
+{
+    MappedFile file{path};
+    return parseTriangles<T>(file.view(), chunks);
+}
+
+template <typename T>
+TriangleTextReader<T>::TriangleTextReader(std::string_view text) : text_(text)
+{
+    const char* end = text.data() + text.size();
+    pos_ = skipSpace(text.data(), end);
+
+    if (pos_ == end)
+        malformed(text, pos_, "missing triangle count");
+
+    pos_ = parseNumber(text, pos_, end, size_, "invalid triangle count");
+}
+
+template <typename T>
+bool TriangleTextReader<T>::next(Triangle3D<T>& tr)
+{
+    const char* end = text_.data() + text_.size();
+
+    if (read_ == size_)
+    {
+        if (skipSpace(pos_, end) != end)
+            malformed(text_, skipSpace(pos_, end), "more than " + std::to_string(9 * size_) + " coordinates");
+
+        return false;
+    }
+
+    T coords[9];
+    for (T& value : coords)
+    {
+        pos_ = skipSpace(pos_, end);
+        if (pos_ == end)
+            malformed(text_, pos_, "expected " + std::to_string(9 * size_) + " coordinates, found " +
+                                   std::to_string(9 * read_ + (&value - coords)));
+
+        pos_ = parseNumber(text_, pos_, end, value, "invalid coordinate");
+    }
+
+    tr = Triangle3D<T>{{coords[0], coords[1], coords[2]}, {coords[3], coords[4], coords[5]},
+                       {coords[6], coords[7], coords[8]}};
+    ++read_;
+
+    return true;
+}
+
+StlView::StlView(std::string_view bytes)
+{
+    if (bytes.size() < HEADER_SIZE)
+        throw std::runtime_error{"binary STL shorter than its header"};
+
+    std::uint32_t count;
+    std::memcpy(&count, bytes.data() + HEADER_SIZE - sizeof(count), sizeof(count));
+
+    // ascii STL files start with "solid" too, a size mismatch is the reliable sign of one
+    if ((bytes.size() - HEADER_SIZE) / RECORD_SIZE < count)
+        throw std::runtime_error{"binary STL with " + std::to_string(count) + " triangles is " +
+                                 std::to_string(bytes.size()) + " bytes long"};
+
+    records_ = bytes.data() + HEADER_SIZE;
+    size_ = count;
+}
+
+template <typename T>
+TriangleSoA<T> loadStl(const std::string& path, std::size_t chunks)
+{
+    MappedFile file{path};
+    StlView stl{file.view()};
+
+    TriangleSoA<T> soa;
+    soa.resize(stl.size());
+
+    chunks = chunkCount(chunks, stl.size() * StlView::RECORD_SIZE);
+
+    runChunks(chunks, [&](std::size_t chunk)
+    {
+        std::size_t end = stl.size() * (chunk + 1) / chunks;
+
+        for (std::size_t idx = stl.size() * chunk / chunks; idx < end; ++idx)
+            for (int vertex = 0; vertex < 3; ++vertex)
+            {
+                Point3D<float> point = stl.point(idx, vertex);
+
+                for (int axis = 0; axis < 3; ++axis)
+                    soa.coord(vertex, static_cast<Axis>(axis))[idx] = point.coords[axis];
+            }
+    });
+
+    return soa;
+}
+
+template TriangleSoA<float> parseTriangles(std::string_view, std::size_t);
+template TriangleSoA<float> loadTriangles(const std::string&, std::size_t);
+template TriangleSoA<float> loadStl(const std::string&, std::size_t);
+template class TriangleTextReader<float>;
+
+template TriangleSoA<double> parseTriangles(std::string_view, std::size_t);
+template TriangleSoA<double> loadTriangles(const std::string&, std::size_t);
+template TriangleSoA<double> loadStl(const std::string&, std::size_t);
+template class TriangleTextReader<double>;
+
+}
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <cmath>
+
+#include "triangle_soa.hh"
+#include "soa_kernels.hh"
+
+namespace geometry3D
+{
+
+namespace
+{
+
+template <typename T>
+struct ScalarPolicy
+{
+    using value_type = T;
+    using reg = T;
+    using mask = bool;
+
+    static constexpr std::size_t WIDTH = 1;
+
+    static reg load(const T* ptr) { return *ptr; }
+    static void store(T* ptr, reg value) { *ptr = value; }
+    static reg set1(T value) { return value; }
+
+    static reg add(reg lhs, reg rhs) { return lhs + rhs; }
+    static reg sub(reg lhs, reg rhs) { return lhs - rhs; }
+    static reg mul(reg lhs, reg rhs) { return lhs * rhs; }
+    static reg div(reg lhs, reg rhs) { return lhs / rhs; }
+    static reg min(reg lhs, reg rhs) { return std::min(lhs, rhs); }
+    static reg max(reg lhs, reg rhs) { return std::max(lhs, rhs); }
+    static reg abs(reg value) { return std::abs(value); }
+    static reg sqrt(reg value) { return std::sqrt(value); }
+
+    static mask lt(reg lhs, reg rhs) { return lhs < rhs; }
+    static mask gt(reg lhs, reg rhs) { return lhs > rhs; }
+    static mask le(reg lhs, reg rhs) { return lhs <= rhs; }
+    static mask ge(reg lhs, reg rhs) { return lhs >= rhs; }
+
+    static mask trueMask() { return true; }
+    static mask andMask(mask lhs, mask rhs) { return lhs && rhs; }
+    static mask orMask(mask lhs, mask rhs) { return lhs || rhs; }
+    static mask notMask(mask value) { return !value; }
+
+    static reg select(mask cond, reg lhs, reg rhs) { return cond ? lhs : rhs; }
+
+    static unsigned bits(mask value) { return value; }
+};
+
+template <typename T>
+const kernels::KernelTable<T>& scalarKernels()
+{
+    static const kernels::KernelTable<T> table = kernels::makeKernelTable<ScalarPolicy<T>>();
+    return table;
+}
+
+bool levelSupported(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::AVX512: return detectSimdLevel() == SimdLevel::AVX512;
+        case SimdLevel::AVX2:   return detectSimdLevel() != SimdLevel::Scalar;
+        default:                return true;
+    }
+}
+
+SimdLevel& currentLevel()
+{
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+template <typename T>
+kernels::SoAView<T> makeView(const TriangleSoA<T>& soa)
+{
+    kernels::SoAView<T> view;
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+        for (int axis = 0; axis < 3; ++axis)
+            view.coord[vertex][axis] = soa.coord(vertex, static_cast<Axis>(axis));
+
+    return view;
+}
+
+template <typename T>
+kernels::QueryData<T> makeQuery(const Triangle3D<T>& tr)
+{
+    kernels::QueryData<T> query;
+
+    for (int vertex = 0; vertex < 3; ++vertex)
+        for (int axis = 0; axis < 3; ++axis)
+            query.vertex[vertex][axis] = tr[vertex].coords[axis];
+
+    const AABB3D<T>& box = tr.box();
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        query.min[axis] = box.min.coords[axis];
+        query.max[axis] = box.max.coords[axis];
+    }
+
+    T first[3], second[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        first[axis] = query.vertex[1][axis] - query.vertex[0][axis];
+        second[axis] = query.vertex[2][axis] - query.vertex[0][axis];
+    }
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        int next = (axis + 1) % 3, last = (axis + 2) % 3;
+
+        T lhs = first[next] * second[last];
+        T rhs = first[last] * second[next];
+
+        query.normal[axis] = lhs - rhs;
+        query.normalTerms[axis] = std::abs(lhs) + std::abs(rhs);
+    }
+
+    // wider than the exact test's box slack, so that the box stage only rejects what it would reject too
+    query.eps = 2 * EPS<T>;
+
+    return query;
+}
+
+}
+
+template <typename T>
+const kernels::KernelTable<T>& kernels::activeKernels()
+{
+    switch (currentLevel())
+    {
+    #ifdef GEOMETRY_X86_SIMD
+        case SimdLevel::AVX512: return avx512Kernels<T>();
+        case SimdLevel::AVX2:   return avx2Kernels<T>();
+    #endif
+        default:                return scalarKernels<T>();
+    }
+}
+
+template const kernels::KernelTable<float>& kernels::activeKernels();
+template const kernels::KernelTable<double>& kernels::activeKernels();
+
+SimdLevel detectSimdLevel()
+{
+#ifdef GEOMETRY_X86_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+#endif
+
+    return SimdLevel::Scalar;
+}
+
+SimdLevel activeSimdLevel()
+{
+    return currentLevel();
+}
+
+bool setSimdLevel(SimdLevel level)
+{
+    if (!levelSupported(level))
+        return false;
+
+    currentLevel() = level;
+    return true;
+}
+
+template <typename T>
+void aabbOverlap(const Triangle3D<T>& query, const TriangleSoA<T>& soa, std::size_t begin, std::size_t end,
+                 std::uint8_t* out)
+{
+    kernels::activeKernels<T>().aabbOverlap(makeQuery(query), makeView(soa), begin, end, out);
+}
+
+template <typename T>
+void planeSideTest(const Triangle3D<T>& query, const TriangleSoA<T>& soa, std::size_t begin, std::size_t end,
+                   std::uint8_t* out)
+{
+    kernels::activeKernels<T>().planeSide(makeQuery(query), makeView(soa), begin, end, out);
+}
+
+template <typename T>
+void triangleBatchIntersect(const Triangle3D<T>& query, const TriangleSoA<T>& soa, std::size_t begin, std::size_t end,
+                            std::uint8_t* out)
+{
+    kernels::activeKernels<T>().narrowPhaseFilter(makeQuery(query), makeView(soa), begin, end, out);
+
+    for (std::size_t idx = begin; idx < end; ++idx)
+        if (out[idx - begin])
+            out[idx - begin] = triangleTriangleIntersect(query, soa[idx]);
+}
+
+template <typename T>
+std::vector<std::size_t> intersectingTriangles(const TriangleSoA<T>& soa)
+{
+    std::size_t size = soa.size();
+
+    std::vector<bool> intersecting(size, false);
+    std::vector<std::uint8_t> batch(size);
+
+    for (std::size_t first = 0; first < size; ++first)
+    {
+        triangleBatchIntersect(soa[first], soa, first + 1, size, batch.data());
+
+        for (std::size_t second = first + 1; second < size; ++second)
+            if (batch[second - first - 1])
+                intersecting[first] = intersecting[second] = true;
+    }
+
+    std::vector<std::size_t> result;
+    for (std::size_t idx = 0; idx < size; ++idx)
+        if (intersecting[idx])
+            result.push_back(idx);
+
+    return result;
+}
+
+template <typename T>
+std::vector<std::size_t> intersectingTriangles(const TriangleSoA<T>& soa, PipelineStats& stats)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::size_t size = soa.size();
+    const kernels::KernelTable<T>& table = kernels::activeKernels<T>();
+    kernels::SoAView<T> view = makeView(soa);
+
+    std::vector<bool> intersecting(size, false);
+    std::vector<std::uint8_t> boxes(size), planeSide(size), filtered(size);
+
+    for (std::size_t first = 0; first < size; ++first)
+    {
+        Triangle3D<T> query = soa[first];
+        kernels::QueryData<T> queryData = makeQuery(query);
+        std::size_t count = size - first - 1;
+
+        auto start = Clock::now();
+        table.aabbOverlap(queryData, view, first + 1, size, boxes.data());
+
+        auto broadEnd = Clock::now();
+        table.narrowPhaseFilter(queryData, view, first + 1, size, filtered.data());
+
+        auto narrowEnd = Clock::now();
+        for (std::size_t idx = 0; idx < count; ++idx)
+            if (filtered[idx])
+            {
+                TriangleTestStage stage;
+                filtered[idx] = triangleTriangleIntersect(query, soa[first + 1 + idx], stage);
+
+                stats.exactDecided[static_cast<std::size_t>(stage)]++;
+            }
+
+        auto exactEnd = Clock::now();
+
+        stats.broadPhaseTime += broadEnd - start;
+        stats.narrowPhaseTime += narrowEnd - broadEnd;
+        stats.exactTime += exactEnd - narrowEnd;
+
+        // not timed, only splits the filters' count
+        table.planeSide(queryData, view, first + 1, size, planeSide.data());
+
+        stats.pairs += count;
+        for (std::size_t idx = 0; idx < count; ++idx)
+        {
+            stats.candidates += boxes[idx];
+            stats.planeSidePassed += boxes[idx] & planeSide[idx];
+
+            if (filtered[idx])
+            {
+                stats.intersectingPairs++;
+                intersecting[first] = intersecting[first + 1 + idx] = true;
+            }
+        }
+    }
+
+    // survivors of the filters are exactly the pairs the exact test saw
+    for (std::uint64_t decided : stats.exactDecided)
+        stats.reversePlaneSidePassed += decided;
+
+    std::vector<std::size_t> result;
+    for (std::size_t idx = 0; idx < size; ++idx)
+        if (intersecting[idx])
+            result.push_back(idx);
+
+    return result;
+}
+
+template void aabbOverlap(const Triangle3D<float>&, const TriangleSoA<float>&, std::size_t, std::size_t, std::uint8_t*);
+template void planeSideTest(const Triangle3D<float>&, const TriangleSoA<float>&, std::size_t, std::size_t, std::uint8_t*);
+template void triangleBatchIntersect(const Triangle3D<float>&, const TriangleSoA<float>&, std::size_t, std::size_t,
+                                     std::uint8_t*);
+template std::vector<std::size_t> intersectingTriangles(const TriangleSoA<float>&);
+template std::vector<std::size_t> intersectingTriangles(const TriangleSoA<float>&, PipelineStats&);
+
+template void aabbOverlap(const Triangle3D<double>&, const TriangleSoA<double>&, std::size_t, std::size_t, std::uint8_t*);
+template void planeSideTest(const Triangle3D<double>&, const TriangleSoA<double>&, std::size_t, std::size_t, std::uint8_t*);
+template void triangleBatchIntersect(const Triangle3D<double>&, const TriangleSoA<double>&, std::size_t, std::size_t,
+                                     std::uint8_t*);
+template std::vector<std::size_t> intersectingTriangles(const TriangleSoA<double>&);
+template std::vector<std::size_t> intersectingTriangles(const TriangleSoA<double>&, PipelineStats&);
+
+}
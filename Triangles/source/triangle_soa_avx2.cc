@@ -0,0 +1,107 @@
+#include <immintrin.h>
+
+#define GEOMETRY_KERNEL_ISA avx2
+#define GEOMETRY_KERNEL_TARGET "avx2"
+#include "soa_kernels.hh"
+
+// the policies and the tables are compiled for the instruction set like the kernels
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace geometry3D::kernels
+{
+
+namespace
+{
+
+struct Avx2Float
+{
+    using value_type = float;
+    using reg = __m256;
+    using mask = __m256;
+
+    static constexpr std::size_t WIDTH = 8;
+
+    static reg load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+    static void store(float* ptr, reg value) { _mm256_storeu_ps(ptr, value); }
+    static reg set1(float value) { return _mm256_set1_ps(value); }
+
+    static reg add(reg lhs, reg rhs) { return _mm256_add_ps(lhs, rhs); }
+    static reg sub(reg lhs, reg rhs) { return _mm256_sub_ps(lhs, rhs); }
+    static reg mul(reg lhs, reg rhs) { return _mm256_mul_ps(lhs, rhs); }
+    static reg div(reg lhs, reg rhs) { return _mm256_div_ps(lhs, rhs); }
+    static reg min(reg lhs, reg rhs) { return _mm256_min_ps(lhs, rhs); }
+    static reg max(reg lhs, reg rhs) { return _mm256_max_ps(lhs, rhs); }
+    static reg abs(reg value) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value); }
+    static reg sqrt(reg value) { return _mm256_sqrt_ps(value); }
+
+    static mask lt(reg lhs, reg rhs) { return _mm256_cmp_ps(lhs, rhs, _CMP_LT_OQ); }
+    static mask gt(reg lhs, reg rhs) { return _mm256_cmp_ps(lhs, rhs, _CMP_GT_OQ); }
+    static mask le(reg lhs, reg rhs) { return _mm256_cmp_ps(lhs, rhs, _CMP_LE_OQ); }
+    static mask ge(reg lhs, reg rhs) { return _mm256_cmp_ps(lhs, rhs, _CMP_GE_OQ); }
+
+    static mask trueMask() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    static mask andMask(mask lhs, mask rhs) { return _mm256_and_ps(lhs, rhs); }
+    static mask orMask(mask lhs, mask rhs) { return _mm256_or_ps(lhs, rhs); }
+    static mask notMask(mask value) { return _mm256_xor_ps(value, trueMask()); }
+
+    static reg select(mask cond, reg lhs, reg rhs) { return _mm256_blendv_ps(rhs, lhs, cond); }
+
+    static unsigned bits(mask value) { return static_cast<unsigned>(_mm256_movemask_ps(value)); }
+};
+
+struct Avx2Double
+{
+    using value_type = double;
+    using reg = __m256d;
+    using mask = __m256d;
+
+    static constexpr std::size_t WIDTH = 4;
+
+    static reg load(const double* ptr) { return _mm256_loadu_pd(ptr); }
+    static void store(double* ptr, reg value) { _mm256_storeu_pd(ptr, value); }
+    static reg set1(double value) { return _mm256_set1_pd(value); }
+
+    static reg add(reg lhs, reg rhs) { return _mm256_add_pd(lhs, rhs); }
+    static reg sub(reg lhs, reg rhs) { return _mm256_sub_pd(lhs, rhs); }
+    static reg mul(reg lhs, reg rhs) { return _mm256_mul_pd(lhs, rhs); }
+    static reg div(reg lhs, reg rhs) { return _mm256_div_pd(lhs, rhs); }
+    static reg min(reg lhs, reg rhs) { return _mm256_min_pd(lhs, rhs); }
+    static reg max(reg lhs, reg rhs) { return _mm256_max_pd(lhs, rhs); }
+    static reg abs(reg value) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), value); }
+    static reg sqrt(reg value) { return _mm256_sqrt_pd(value); }
+
+    static mask lt(reg lhs, reg rhs) { return _mm256_cmp_pd(lhs, rhs, _CMP_LT_OQ); }
+    static mask gt(reg lhs, reg rhs) { return _mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ); }
+    static mask le(reg lhs, reg rhs) { return _mm256_cmp_pd(lhs, rhs, _CMP_LE_OQ); }
+    static mask ge(reg lhs, reg rhs) { return _mm256_cmp_pd(lhs, rhs, _CMP_GE_OQ); }
+
+    static mask trueMask() { return _mm256_castsi256_pd(_mm256_set1_epi64x(-1)); }
+    static mask andMask(mask lhs, mask rhs) { return _mm256_and_pd(lhs, rhs); }
+    static mask orMask(mask lhs, mask rhs) { return _mm256_or_pd(lhs, rhs); }
+    static mask notMask(mask value) { return _mm256_xor_pd(value, trueMask()); }
+
+    static reg select(mask cond, reg lhs, reg rhs) { return _mm256_blendv_pd(rhs, lhs, cond); }
+
+    static unsigned bits(mask value) { return static_cast<unsigned>(_mm256_movemask_pd(value)); }
+};
+
+}
+
+template <>
+const KernelTable<float>& avx2Kernels<float>()
+{
+    static const KernelTable<float> table = makeKernelTable<Avx2Float>();
+    return table;
+}
+
+template <>
+const KernelTable<double>& avx2Kernels<double>()
+{
+    static const KernelTable<double> table = makeKernelTable<Avx2Double>();
+    return table;
+}
+
+}
+
+#pragma GCC pop_options
@@ -0,0 +1,107 @@
+#include <immintrin.h>
+
+#define GEOMETRY_KERNEL_ISA avx512
+#define GEOMETRY_KERNEL_TARGET "avx512f"
+#include "soa_kernels.hh"
+
+// the policies and the tables are compiled for the instruction set like the kernels
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace geometry3D::kernels
+{
+
+namespace
+{
+
+struct Avx512Float
+{
+    using value_type = float;
+    using reg = __m512;
+    using mask = __mmask16;
+
+    static constexpr std::size_t WIDTH = 16;
+
+    static reg load(const float* ptr) { return _mm512_loadu_ps(ptr); }
+    static void store(float* ptr, reg value) { _mm512_storeu_ps(ptr, value); }
+    static reg set1(float value) { return _mm512_set1_ps(value); }
+
+    static reg add(reg lhs, reg rhs) { return _mm512_add_ps(lhs, rhs); }
+    static reg sub(reg lhs, reg rhs) { return _mm512_sub_ps(lhs, rhs); }
+    static reg mul(reg lhs, reg rhs) { return _mm512_mul_ps(lhs, rhs); }
+    static reg div(reg lhs, reg rhs) { return _mm512_div_ps(lhs, rhs); }
+    static reg min(reg lhs, reg rhs) { return _mm512_min_ps(lhs, rhs); }
+    static reg max(reg lhs, reg rhs) { return _mm512_max_ps(lhs, rhs); }
+    static reg abs(reg value) { return _mm512_abs_ps(value); }
+    static reg sqrt(reg value) { return _mm512_sqrt_ps(value); }
+
+    static mask lt(reg lhs, reg rhs) { return _mm512_cmp_ps_mask(lhs, rhs, _CMP_LT_OQ); }
+    static mask gt(reg lhs, reg rhs) { return _mm512_cmp_ps_mask(lhs, rhs, _CMP_GT_OQ); }
+    static mask le(reg lhs, reg rhs) { return _mm512_cmp_ps_mask(lhs, rhs, _CMP_LE_OQ); }
+    static mask ge(reg lhs, reg rhs) { return _mm512_cmp_ps_mask(lhs, rhs, _CMP_GE_OQ); }
+
+    static mask trueMask() { return 0xFFFF; }
+    static mask andMask(mask lhs, mask rhs) { return lhs & rhs; }
+    static mask orMask(mask lhs, mask rhs) { return lhs | rhs; }
+    static mask notMask(mask value) { return static_cast<mask>(~value); }
+
+    static reg select(mask cond, reg lhs, reg rhs) { return _mm512_mask_blend_ps(cond, rhs, lhs); }
+
+    static unsigned bits(mask value) { return value; }
+};
+
+struct Avx512Double
+{
+    using value_type = double;
+    using reg = __m512d;
+    using mask = __mmask8;
+
+    static constexpr std::size_t WIDTH = 8;
+
+    static reg load(const double* ptr) { return _mm512_loadu_pd(ptr); }
+    static void store(double* ptr, reg value) { _mm512_storeu_pd(ptr, value); }
+    static reg set1(double value) { return _mm512_set1_pd(value); }
+
+    static reg add(reg lhs, reg rhs) { return _mm512_add_pd(lhs, rhs); }
+    static reg sub(reg lhs, reg rhs) { return _mm512_sub_pd(lhs, rhs); }
+    static reg mul(reg lhs, reg rhs) { return _mm512_mul_pd(lhs, rhs); }
+    static reg div(reg lhs, reg rhs) { return _mm512_div_pd(lhs, rhs); }
+    static reg min(reg lhs, reg rhs) { return _mm512_min_pd(lhs, rhs); }
+    static reg max(reg lhs, reg rhs) { return _mm512_max_pd(lhs, rhs); }
+    static reg abs(reg value) { return _mm512_abs_pd(value); }
+    static reg sqrt(reg value) { return _mm512_sqrt_pd(value); }
+
+    static mask lt(reg lhs, reg rhs) { return _mm512_cmp_pd_mask(lhs, rhs, _CMP_LT_OQ); }
+    static mask gt(reg lhs, reg rhs) { return _mm512_cmp_pd_mask(lhs, rhs, _CMP_GT_OQ); }
+    static mask le(reg lhs, reg rhs) { return _mm512_cmp_pd_mask(lhs, rhs, _CMP_LE_OQ); }
+    static mask ge(reg lhs, reg rhs) { return _mm512_cmp_pd_mask(lhs, rhs, _CMP_GE_OQ); }
+
+    static mask trueMask() { return 0xFF; }
+    static mask andMask(mask lhs, mask rhs) { return lhs & rhs; }
+    static mask orMask(mask lhs, mask rhs) { return lhs | rhs; }
+    static mask notMask(mask value) { return static_cast<mask>(~value); }
+
+    static reg select(mask cond, reg lhs, reg rhs) { return _mm512_mask_blend_pd(cond, rhs, lhs); }
+
+    static unsigned bits(mask value) { return value; }
+};
+
+}
+
+template <>
+const KernelTable<float>& avx512Kernels<float>()
+{
+    static const KernelTable<float> table = makeKernelTable<Avx512Float>();
+    return table;
+}
+
+template <>
+const KernelTable<double>& avx512Kernels<double>()
+{
+    static const KernelTable<double> table = makeKernelTable<Avx512Double>();
+    return table;
+}
+
+}
+
+#pragma GCC pop_options
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "bvh.hh"
+
+using namespace geometry3D;
+
+namespace
+{
+
+template <typename T>
+std::vector<AABB3D<T>> randomBoxes(std::size_t count, unsigned seed)
+{
+    std::mt19937 gen{seed};
+    std::uniform_real_distribution<T> position{0, 100};
+    std::uniform_real_distribution<T> extent{0, 2};
+
+    std::vector<AABB3D<T>> boxes;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Point3D<T> min{position(gen), position(gen), position(gen)};
+        Point3D<T> max{min.coords[X] + extent(gen), min.coords[Y] + extent(gen), min.coords[Z] + extent(gen)};
+        boxes.push_back(AABB3D<T>{min, max});
+    }
+
+    return boxes;
+}
+
+template <typename T>
+bool contains(const BVHNode<T>& node, const AABB3D<T>& box)
+{
+    for (int axis = 0; axis < 3; ++axis)
+        if (box.min.coords[axis] < node.min[axis] || box.max.coords[axis] > node.max[axis])
+            return false;
+
+    return true;
+}
+
+// every primitive is reached exactly once and lies in all boxes on its way from the root
+template <typename T>
+void checkNode(const BVH<T>& bvh, const std::vector<AABB3D<T>>& boxes, std::uint32_t nodeIdx, std::size_t depth,
+               std::vector<int>& seen)
+{
+    const BVHNode<T>& node = bvh.nodes()[nodeIdx];
+    ASSERT_LT(depth, BVH<T>::MAX_DEPTH);
+
+    if (node.leaf())
+    {
+        for (std::uint32_t idx = node.first; idx < node.first + node.count; ++idx)
+        {
+            std::uint32_t primitive = bvh.order()[idx];
+            EXPECT_TRUE(contains(node, boxes[primitive]));
+            seen[primitive]++;
+        }
+        return;
+    }
+
+    for (std::uint32_t child = node.first; child < node.first + 2; ++child)
+    {
+        const BVHNode<T>& inner = bvh.nodes()[child];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            EXPECT_LE(node.min[axis], inner.min[axis]);
+            EXPECT_GE(node.max[axis], inner.max[axis]);
+        }
+
+        checkNode(bvh, boxes, child, depth + 1, seen);
+    }
+}
+
+template <typename T>
+class BVHTest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(BVHTest, ScalarTypes);
+
+}
+
+TYPED_TEST(BVHTest, CoversEveryBox)
+{
+    std::vector<AABB3D<TypeParam>> boxes = randomBoxes<TypeParam>(1000, 3);
+    BVH<TypeParam> bvh{boxes};
+
+    std::vector<int> seen(boxes.size(), 0);
+    checkNode(bvh, boxes, 0, 0, seen);
+
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; }));
+}
+
+TYPED_TEST(BVHTest, CoincidentBoxes)
+{
+    std::vector<AABB3D<TypeParam>> boxes(100, AABB3D<TypeParam>{{0, 0, 0}, {1, 1, 1}});
+    BVH<TypeParam> bvh{boxes};
+
+    std::vector<int> seen(boxes.size(), 0);
+    checkNode(bvh, boxes, 0, 0, seen);
+
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; }));
+}
+
+TYPED_TEST(BVHTest, Empty)
+{
+    BVH<TypeParam> bvh{std::vector<AABB3D<TypeParam>>{}};
+
+    EXPECT_TRUE(bvh.empty());
+    EXPECT_TRUE(bvh.order().empty());
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "distance_query.hh"
+#include "test_helpers.hh"
+#include "triangle_soa.hh"
+
+using namespace geometry3D;
+using namespace helpers;
+
+namespace
+{
+
+// random triangles shifted along x, with the special ones and one with an invalid vertex
+template <typename T>
+std::vector<Triangle3D<T>> sceneTriangles(std::size_t count, T shift, unsigned seed)
+{
+    Point3D<T> origin{shift, 0, 0};
+
+    std::vector<Triangle3D<T>> triangles = randomTriangles<T>(count, seed, 10, origin);
+    appendSpecialTriangles(triangles, origin);
+    triangles.push_back(Triangle3D<T>{{1, 1, 1}, {2, 2, 2}, {}});
+
+    return triangles;
+}
+
+template <typename T>
+DistanceResult<T> bruteForceClosest(const std::vector<Triangle3D<T>>& lhs, const std::vector<Triangle3D<T>>& rhs)
+{
+    DistanceResult<T> closest;
+
+    for (std::size_t first = 0; first < lhs.size(); ++first)
+        for (std::size_t second = 0; second < rhs.size(); ++second)
+        {
+            DistanceResult<T> result = triangleTriangleDistance(lhs[first], rhs[second]);
+            if (result.valid() && (!closest.valid() || result.distance < closest.distance))
+            {
+                closest = result;
+                closest.firstTriangle = first;
+                closest.secondTriangle = second;
+            }
+        }
+
+    return closest;
+}
+
+template <typename T>
+class DistanceQueryTest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(DistanceQueryTest, ScalarTypes);
+
+}
+
+TYPED_TEST(DistanceQueryTest, SegmentSegment)
+{
+    using Segment = Segment3D<TypeParam>;
+    Segment axis{{0, 0, 0}, {2, 0, 0}};
+
+    DistanceResult<TypeParam> skew = segmentSegmentDistance(axis, Segment{{1, -1, 1}, {1, 1, 1}});
+    EXPECT_FLOAT_EQ(skew.distance, 1);
+    EXPECT_EQ(skew.first, (Point3D<TypeParam>{1, 0, 0}));
+    EXPECT_EQ(skew.second, (Point3D<TypeParam>{1, 0, 1}));
+
+    DistanceResult<TypeParam> parallel = segmentSegmentDistance(axis, Segment{{3, 1, 0}, {5, 1, 0}});
+    EXPECT_FLOAT_EQ(parallel.distance, std::sqrt(TypeParam{2}));
+    EXPECT_EQ(parallel.first, (Point3D<TypeParam>{2, 0, 0}));
+    EXPECT_EQ(parallel.second, (Point3D<TypeParam>{3, 1, 0}));
+
+    DistanceResult<TypeParam> point = segmentSegmentDistance(Segment{{1, 1, 0}, {1, 1, 0}}, axis);
+    EXPECT_FLOAT_EQ(point.distance, 1);
+    EXPECT_EQ(point.second, (Point3D<TypeParam>{1, 0, 0}));
+
+    EXPECT_FLOAT_EQ(segmentSegmentDistance(axis, Segment{{1, -1, 0}, {1, 1, 0}}).distance, 0);
+    EXPECT_FALSE(segmentSegmentDistance(axis, Segment{{1, -1, 0}, {}}).valid());
+}
+
+TYPED_TEST(DistanceQueryTest, PointTriangle)
+{
+    Triangle3D<TypeParam> tr{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}};
+
+    DistanceResult<TypeParam> above = pointTriangleDistance(Point3D<TypeParam>{0.5, 0.5, 3}, tr);
+    EXPECT_FLOAT_EQ(above.distance, 3);
+    EXPECT_EQ(above.second, (Point3D<TypeParam>{0.5, 0.5, 0}));
+
+    DistanceResult<TypeParam> corner = pointTriangleDistance(Point3D<TypeParam>{-1, -1, 0}, tr);
+    EXPECT_FLOAT_EQ(corner.distance, std::sqrt(TypeParam{2}));
+    EXPECT_EQ(corner.second, (Point3D<TypeParam>{0, 0, 0}));
+
+    DistanceResult<TypeParam> edge = pointTriangleDistance(Point3D<TypeParam>{1, -2, 1}, tr);
+    EXPECT_FLOAT_EQ(edge.distance, std::sqrt(TypeParam{5}));
+    EXPECT_EQ(edge.second, (Point3D<TypeParam>{1, 0, 0}));
+
+    Triangle3D<TypeParam> segment{{0, 0, 0}, {2, 0, 0}, {1, 0, 0}};
+    EXPECT_FLOAT_EQ(pointTriangleDistance(Point3D<TypeParam>{1, 1, 0}, segment).distance, 1);
+
+    EXPECT_FALSE(pointTriangleDistance(Point3D<TypeParam>{}, tr).valid());
+}
+
+TYPED_TEST(DistanceQueryTest, TriangleTriangle)
+{
+    Triangle3D<TypeParam> tr{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}};
+
+    DistanceResult<TypeParam> stacked = triangleTriangleDistance(tr, Triangle3D<TypeParam>{{0.2, 0.2, 2}, {1, 0.2, 2},
+                                                                                            {0.2, 1, 2}});
+    EXPECT_FLOAT_EQ(stacked.distance, 2);
+    EXPECT_FLOAT_EQ(stacked.first.coords[Z], 0);
+    EXPECT_FLOAT_EQ(stacked.second.coords[Z], 2);
+
+    DistanceResult<TypeParam> edges = triangleTriangleDistance(tr, Triangle3D<TypeParam>{{3, 3, -1}, {3, 3, 1}, {5, 5, 0}});
+    EXPECT_FLOAT_EQ(edges.distance, std::sqrt(TypeParam{8}));
+    EXPECT_EQ(edges.first, (Point3D<TypeParam>{1, 1, 0}));
+    EXPECT_EQ(edges.second, (Point3D<TypeParam>{3, 3, 0}));
+
+    // an edge of the second triangle pierces the first one's face
+    Triangle3D<TypeParam> piercing{{0.5, 0.5, -1}, {0.5, 0.5, 1}, {3, 3, 0}};
+    DistanceResult<TypeParam> crossing = triangleTriangleDistance(tr, piercing);
+    EXPECT_FLOAT_EQ(crossing.distance, 0);
+    EXPECT_EQ(crossing.first, crossing.second);
+    EXPECT_NEAR(pointTriangleDistance(crossing.first, tr).distance, 0, EPS<TypeParam>);
+    EXPECT_NEAR(pointTriangleDistance(crossing.first, piercing).distance, 0, EPS<TypeParam>);
+
+    // coplanar, one inside the other
+    EXPECT_FLOAT_EQ(triangleTriangleDistance(tr, Triangle3D<TypeParam>{{0.2, 0.2, 0}, {1, 0.2, 0}, {0.2, 1, 0}}).distance, 0);
+
+    EXPECT_FALSE(triangleTriangleDistance(tr, Triangle3D<TypeParam>{{0, 0, 0}, {1, 0, 0}, {}}).valid());
+}
+
+TYPED_TEST(DistanceQueryTest, AgreesWithIntersection)
+{
+    std::vector<Triangle3D<TypeParam>> triangles = sceneTriangles<TypeParam>(300, 0, 3);
+
+    for (std::size_t first = 0; first < triangles.size(); ++first)
+        for (std::size_t second = first + 1; second < triangles.size(); ++second)
+        {
+            DistanceResult<TypeParam> result = triangleTriangleDistance(triangles[first], triangles[second]);
+            if (!result.valid())
+                continue;
+
+            // the intersection test has a tolerance, the distance does not
+            if (triangleTriangleIntersect(triangles[first], triangles[second]))
+            {
+                EXPECT_LE(result.distance, 10 * EPS<TypeParam>) << first << ' ' << second;
+            }
+            else
+            {
+                EXPECT_GT(result.distance, 0) << first << ' ' << second;
+            }
+        }
+}
+
+TYPED_TEST(DistanceQueryTest, SceneMatchesBruteForce)
+{
+    // overlapping, close and far apart sets
+    for (TypeParam shift : {TypeParam{0}, TypeParam{10.5}, TypeParam{30}})
+    {
+        std::vector<Triangle3D<TypeParam>> lhs = sceneTriangles<TypeParam>(400, 0, 7);
+        std::vector<Triangle3D<TypeParam>> rhs = sceneTriangles<TypeParam>(300, shift, 8);
+
+        DistanceScene<TypeParam> lhsScene{lhs}, rhsScene{rhs};
+        EXPECT_EQ(lhsScene.size(), lhs.size() - 1);
+
+        DistanceResult<TypeParam> expected = bruteForceClosest(lhs, rhs);
+        ASSERT_TRUE(expected.valid());
+
+        for (SimdLevel level : supportedLevels())
+        {
+            ASSERT_TRUE(setSimdLevel(level));
+
+            for (bool swapped : {false, true})
+            {
+                DistanceResult<TypeParam> result = swapped ? rhsScene.closest(lhsScene) : lhsScene.closest(rhsScene);
+                ASSERT_TRUE(result.valid()) << "level " << static_cast<int>(level);
+
+                std::size_t first = swapped ? result.secondTriangle : result.firstTriangle;
+                std::size_t second = swapped ? result.firstTriangle : result.secondTriangle;
+
+                EXPECT_NEAR(result.distance, expected.distance, EPS<TypeParam>) << "level " << static_cast<int>(level);
+                EXPECT_FLOAT_EQ(triangleTriangleDistance(lhs[first], rhs[second]).distance, result.distance);
+
+                const Point3D<TypeParam>& onLhs = swapped ? result.second : result.first;
+                EXPECT_NEAR(pointTriangleDistance(onLhs, lhs[first]).distance, 0, EPS<TypeParam>);
+            }
+        }
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+TYPED_TEST(DistanceQueryTest, MaxDistanceAndEmptyScenes)
+{
+    std::vector<Triangle3D<TypeParam>> lhs = sceneTriangles<TypeParam>(100, 0, 1);
+    std::vector<Triangle3D<TypeParam>> rhs = sceneTriangles<TypeParam>(100, 20, 2);
+
+    DistanceScene<TypeParam> lhsScene{lhs}, rhsScene{rhs};
+    DistanceResult<TypeParam> closest = lhsScene.closest(rhsScene);
+    ASSERT_TRUE(closest.valid());
+
+    EXPECT_FALSE(lhsScene.closest(rhsScene, closest.distance / 2).valid());
+    EXPECT_FALSE(lhsScene.closest(rhsScene, geometry3D::nan<TypeParam>).valid());
+    EXPECT_EQ(lhsScene.closest(rhsScene, closest.distance * 2).distance, closest.distance);
+
+    DistanceScene<TypeParam> empty{std::vector<Triangle3D<TypeParam>>{}};
+    EXPECT_FALSE(empty.closest(lhsScene).valid());
+    EXPECT_FALSE(lhsScene.closest(empty).valid());
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <set>
+
+#include "dynamic_scene.hh"
+#include "test_helpers.hh"
+
+using namespace geometry3D;
+using namespace helpers;
+
+namespace
+{
+
+template <typename T>
+Triangle3D<T> moved(const Triangle3D<T>& tr, T dx, T dy, T dz)
+{
+    auto shift = [&](const Point3D<T>& point)
+    {
+        return Point3D<T>{point.coords[X] + dx, point.coords[Y] + dy, point.coords[Z] + dz};
+    };
+
+    return Triangle3D<T>{shift(tr[0]), shift(tr[1]), shift(tr[2])};
+}
+
+template <typename T>
+std::set<typename DynamicScene<T>::Pair> bruteForcePairs(const DynamicScene<T>& scene, const std::vector<std::uint32_t>& ids)
+{
+    std::set<typename DynamicScene<T>::Pair> pairs;
+
+    for (std::size_t first = 0; first < ids.size(); ++first)
+        for (std::size_t second = first + 1; second < ids.size(); ++second)
+            if (triangleTriangleIntersect(scene.triangle(ids[first]), scene.triangle(ids[second])))
+                pairs.insert(std::minmax(ids[first], ids[second]));
+
+    return pairs;
+}
+
+template <typename T>
+class DynamicSceneTest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(DynamicSceneTest, ScalarTypes);
+
+}
+
+TYPED_TEST(DynamicSceneTest, ChangesTrackBruteForce)
+{
+    using Scene = DynamicScene<TypeParam>;
+
+    std::mt19937 gen{21};
+    Scene scene{TypeParam(0.2)};
+
+    std::vector<std::uint32_t> ids;
+    for (int i = 0; i < 300; ++i)
+        ids.push_back(scene.insert(randomTriangle<TypeParam>(gen, 15)));
+
+    std::set<typename Scene::Pair> pairs;
+
+    for (int frame = 0; frame < 30; ++frame)
+    {
+        typename Scene::Changes changes = scene.commit();
+
+        for (const auto& pair : changes.removed)
+            ASSERT_EQ(pairs.erase(pair), 1) << "frame " << frame;
+        for (const auto& pair : changes.added)
+            ASSERT_TRUE(pairs.insert(pair).second) << "frame " << frame;
+
+        ASSERT_EQ(pairs, bruteForcePairs(scene, ids)) << "frame " << frame;
+
+        std::uniform_real_distribution<TypeParam> step{-0.3, 0.3};
+        std::uniform_int_distribution<std::size_t> pick{0, ids.size() - 1};
+
+        // small moves, a few jumps, removals and insertions
+        for (int edit = 0; edit < 20; ++edit)
+        {
+            std::uint32_t id = ids[pick(gen)];
+            scene.update(id, moved(scene.triangle(id), step(gen), step(gen), step(gen)));
+        }
+
+        std::uint32_t jumping = ids[pick(gen)];
+        scene.update(jumping, randomTriangle<TypeParam>(gen, 15));
+
+        std::size_t removed = pick(gen);
+        scene.remove(ids[removed]);
+        ids.erase(ids.begin() + removed);
+
+        ids.push_back(scene.insert(randomTriangle<TypeParam>(gen, 15)));
+    }
+
+    EXPECT_EQ(scene.size(), ids.size());
+    EXPECT_LE(scene.tree().height(), 20);
+}
+
+TYPED_TEST(DynamicSceneTest, ReportsOnlyChanges)
+{
+    using Scene = DynamicScene<TypeParam>;
+    Scene scene;
+
+    auto first = scene.insert(Triangle3D<TypeParam>{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}});
+    auto second = scene.insert(Triangle3D<TypeParam>{{0.2, 0.2, -1}, {0.2, 0.2, 1}, {5, 5, 0}});
+    auto far = scene.insert(Triangle3D<TypeParam>{{10, 10, 10}, {11, 10, 10}, {10, 11, 10}});
+
+    typename Scene::Changes changes = scene.commit();
+    EXPECT_EQ(changes.added, (std::vector<typename Scene::Pair>{{first, second}}));
+    EXPECT_TRUE(changes.removed.empty());
+
+    changes = scene.commit();
+    EXPECT_TRUE(changes.added.empty());
+    EXPECT_TRUE(changes.removed.empty());
+
+    scene.update(far, moved(scene.triangle(far), TypeParam(1), TypeParam(0), TypeParam(0)));
+    changes = scene.commit();
+    EXPECT_TRUE(changes.added.empty());
+    EXPECT_TRUE(changes.removed.empty());
+
+    scene.update(second, moved(scene.triangle(second), TypeParam(0), TypeParam(0), TypeParam(5)));
+    changes = scene.commit();
+    EXPECT_TRUE(changes.added.empty());
+    EXPECT_EQ(changes.removed, (std::vector<typename Scene::Pair>{{first, second}}));
+    EXPECT_TRUE(scene.intersecting(first).empty());
+}
+
+TYPED_TEST(DynamicSceneTest, RemovedIdsAreReusedAfterCommit)
+{
+    using Scene = DynamicScene<TypeParam>;
+    Scene scene;
+
+    Triangle3D<TypeParam> tr{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    Triangle3D<TypeParam> crossing{{0.2, 0.2, -1}, {0.2, 0.2, 1}, {5, 5, 0}};
+
+    auto first = scene.insert(tr);
+    auto second = scene.insert(crossing);
+    scene.commit();
+
+    scene.remove(second);
+    auto third = scene.insert(crossing);
+    EXPECT_NE(third, second);
+    EXPECT_FALSE(scene.contains(second));
+
+    typename Scene::Changes changes = scene.commit();
+    EXPECT_EQ(changes.removed, (std::vector<typename Scene::Pair>{{first, second}}));
+    EXPECT_EQ(changes.added, (std::vector<typename Scene::Pair>{{first, third}}));
+
+    EXPECT_EQ(scene.insert(tr), second);
+}
+
+TYPED_TEST(DynamicSceneTest, InvalidTrianglesIntersectNothing)
+{
+    using Scene = DynamicScene<TypeParam>;
+    Scene scene;
+
+    auto first = scene.insert(Triangle3D<TypeParam>{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}});
+    auto second = scene.insert(Triangle3D<TypeParam>{{0.2, 0.2, -1}, {}, {5, 5, 0}});
+
+    EXPECT_TRUE(scene.commit().added.empty());
+
+    scene.update(second, Triangle3D<TypeParam>{{0.2, 0.2, -1}, {0.2, 0.2, 1}, {5, 5, 0}});
+    EXPECT_EQ(scene.commit().added, (std::vector<typename Scene::Pair>{{first, second}}));
+
+    scene.update(second, Triangle3D<TypeParam>{{0.2, 0.2, -1}, {}, {5, 5, 0}});
+    EXPECT_EQ(scene.commit().removed, (std::vector<typename Scene::Pair>{{first, second}}));
+}
@@ -0,0 +1,92 @@
+#ifndef TEST_HELPERS_HH
+#define TEST_HELPERS_HH
+
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "geometry3D.hh"
+#include "triangle_soa.hh"
+
+
+// Fixtures shared by the tests.
+namespace helpers
+{
+
+using geometry3D::Point3D;
+using geometry3D::SimdLevel;
+using geometry3D::Triangle3D;
+using geometry3D::TriangleSoA;
+
+// vertices within 1 of a uniformly distributed position in origin + [0, spread)^3
+template <typename T>
+Triangle3D<T> randomTriangle(std::mt19937& gen, T spread = 10, const Point3D<T>& origin = Point3D<T>{0, 0, 0})
+{
+    std::uniform_real_distribution<T> position{0, spread};
+    std::uniform_real_distribution<T> offset{-1, 1};
+
+    T x = origin.coords[0] + position(gen), y = origin.coords[1] + position(gen), z = origin.coords[2] + position(gen);
+    return Triangle3D<T>{{x + offset(gen), y + offset(gen), z + offset(gen)},
+                         {x + offset(gen), y + offset(gen), z + offset(gen)},
+                         {x + offset(gen), y + offset(gen), z + offset(gen)}};
+}
+
+template <typename T>
+std::vector<Triangle3D<T>> randomTriangles(std::size_t count, unsigned seed, T spread = 10,
+                                           const Point3D<T>& origin = Point3D<T>{0, 0, 0})
+{
+    std::mt19937 gen{seed};
+
+    std::vector<Triangle3D<T>> triangles;
+    for (std::size_t i = 0; i < count; ++i)
+        triangles.push_back(randomTriangle(gen, spread, origin));
+
+    return triangles;
+}
+
+// two overlapping coplanar triangles, a segment crossing their plane and a point on it, placed like
+// randomTriangles with the same origin
+template <typename T>
+void appendSpecialTriangles(std::vector<Triangle3D<T>>& triangles, const Point3D<T>& origin = Point3D<T>{0, 0, 0})
+{
+    auto at = [&](T x, T y, T z)
+    {
+        return Point3D<T>{origin.coords[0] + x, origin.coords[1] + y, origin.coords[2] + z};
+    };
+
+    triangles.push_back(Triangle3D<T>{at(1, 1, 5), at(3, 1, 5), at(1, 3, 5)});
+    triangles.push_back(Triangle3D<T>{at(2, 2, 5), at(4, 2, 5), at(2, 4, 5)});
+    triangles.push_back(Triangle3D<T>{at(2, 2, 4), at(2, 2, 6), at(2, 2, 5)});
+    triangles.push_back(Triangle3D<T>{at(2, 2, 5), at(2, 2, 5), at(2, 2, 5)});
+}
+
+template <typename T>
+TriangleSoA<T> toSoA(const std::vector<Triangle3D<T>>& triangles)
+{
+    TriangleSoA<T> soa;
+    soa.reserve(triangles.size());
+
+    for (const Triangle3D<T>& tr : triangles)
+        soa.push_back(tr);
+
+    return soa;
+}
+
+// the levels this CPU runs, the scalar one first
+inline std::vector<SimdLevel> supportedLevels()
+{
+    std::vector<SimdLevel> levels{SimdLevel::Scalar};
+
+    if (geometry3D::detectSimdLevel() != SimdLevel::Scalar)
+        levels.push_back(SimdLevel::AVX2);
+    if (geometry3D::detectSimdLevel() == SimdLevel::AVX512)
+        levels.push_back(SimdLevel::AVX512);
+
+    return levels;
+}
+
+}
+
+
+#endif
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "indexed_mesh.hh"
+
+using namespace geometry3D;
+
+namespace
+{
+
+// flat grid of size x size quads at z = 0, two triangles each
+std::vector<Triangle3D<double>> gridSoup(int size)
+{
+    std::vector<Triangle3D<double>> soup;
+
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+        {
+            Point3D<double> a{double(i), double(j), 0};
+            Point3D<double> b{double(i + 1), double(j), 0};
+            Point3D<double> c{double(i), double(j + 1), 0};
+            Point3D<double> d{double(i + 1), double(j + 1), 0};
+
+            soup.push_back(Triangle3D<double>{a, b, d});
+            soup.push_back(Triangle3D<double>{a, d, c});
+        }
+
+    return soup;
+}
+
+}
+
+TEST(IndexedMesh, WeldsVertices)
+{
+    auto soup = gridSoup(10);
+    auto mesh = IndexedMesh<double>::fromTriangles(soup.begin(), soup.end());
+
+    EXPECT_EQ(mesh.faceCount(), 200);
+    EXPECT_EQ(mesh.vertexCount(), 121);
+
+    for (std::size_t idx = 0; idx < soup.size(); ++idx)
+        for (int vertex = 0; vertex < 3; ++vertex)
+            EXPECT_EQ(mesh.triangle(idx)[vertex], soup[idx][vertex]);
+}
+
+TEST(IndexedMesh, Adjacency)
+{
+    IndexedMesh<double> mesh;
+    auto a = mesh.addVertex({0, 0, 0});
+    auto b = mesh.addVertex({1, 0, 0});
+    auto c = mesh.addVertex({0, 1, 0});
+    auto d = mesh.addVertex({1, 1, 0});
+    auto e = mesh.addVertex({5, 5, 5});
+    auto f = mesh.addVertex({6, 5, 5});
+
+    mesh.addFace(a, b, c);
+    mesh.addFace(b, d, c);
+    mesh.addFace(d, e, f);
+    mesh.addFace(e, f, mesh.addVertex({5, 6, 5}));
+
+    EXPECT_TRUE(mesh.adjacent(0, 1));
+    EXPECT_TRUE(mesh.adjacent(1, 2));
+    EXPECT_FALSE(mesh.adjacent(0, 2));
+    EXPECT_FALSE(mesh.adjacent(0, 3));
+}
+
+TEST(IndexedMesh, NeighboursAreNotIntersections)
+{
+    auto soup = gridSoup(10);
+    auto mesh = IndexedMesh<double>::fromTriangles(soup.begin(), soup.end());
+
+    EXPECT_TRUE(intersectingTriangles(mesh).empty());
+
+    // a separate triangle piercing the grid inside face 0
+    soup.push_back(Triangle3D<double>{{0.7, 0.2, -1}, {0.7, 0.2, 1}, {0.9, 0.3, 0.5}});
+    mesh = IndexedMesh<double>::fromTriangles(soup.begin(), soup.end());
+
+    EXPECT_EQ(intersectingTriangles(mesh), (std::vector<std::size_t>{0, 200}));
+}
+
+TEST(IndexedMesh, InvalidFacesIntersectNothing)
+{
+    auto soup = gridSoup(10);
+    soup.push_back(Triangle3D<double>{{0.7, 0.2, -1}, {0.7, 0.2, 1}, {0.9, 0.3, 0.5}});
+
+    IndexedMesh<double> mesh = IndexedMesh<double>::fromTriangles(soup.begin(), soup.end());
+
+    // faces with a nan vertex spread among the valid ones, each on its own nan vertex
+    for (int idx = 0; idx < 50; ++idx)
+        mesh.addFace(mesh.addVertex({}), mesh.addVertex({double(idx % 10), 0.5, 0}), mesh.addVertex({0.5, double(idx % 7), 1}));
+
+    EXPECT_EQ(intersectingTriangles(mesh), (std::vector<std::size_t>{0, 200}));
+}
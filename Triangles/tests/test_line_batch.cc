@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+
+#include "line_batch.hh"
+#include "test_helpers.hh"
+#include "triangle_soa.hh"
+
+using namespace geometry3D;
+using namespace helpers;
+
+namespace
+{
+
+template <typename T>
+std::vector<Line3D<T>> randomLines(std::size_t count, unsigned seed)
+{
+    std::mt19937 gen{seed};
+    std::uniform_int_distribution<int> coord{-4, 4};
+
+    // small integer coordinates make parallel and intersecting pairs common
+    std::vector<Line3D<T>> lines;
+    for (std::size_t i = 0; i < count; ++i)
+        lines.push_back(Line3D<T>{{T(coord(gen)), T(coord(gen)), T(coord(gen))},
+                                  {T(coord(gen)), T(coord(gen)), T(coord(gen))}});
+
+    lines.push_back(Line3D<T>{});
+    lines.push_back(Line3D<T>{{0, 0, 0}, {1, 1, 1}});
+    lines.push_back(Line3D<T>{{1, 0, 0}, {0, 0, geometry3D::nan<T>}});
+
+    return lines;
+}
+
+template <typename T>
+struct Output
+{
+    std::vector<T> x, y, z;
+    std::vector<std::uint8_t> hit;
+
+    explicit Output(std::size_t size) : x(size), y(size), z(size), hit(size)
+    {}
+
+    IntersectionOutput<T> spans()
+    {
+        return IntersectionOutput<T>{x, y, z, hit};
+    }
+
+    Point3D<T> point(std::size_t idx) const
+    {
+        return Point3D<T>{x[idx], y[idx], z[idx]};
+    }
+};
+
+template <typename T>
+class LineBatchTest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(LineBatchTest, ScalarTypes);
+
+}
+
+TYPED_TEST(LineBatchTest, PlaneLineMatchesScalar)
+{
+    std::vector<Line3D<TypeParam>> lines = randomLines<TypeParam>(101, 7);
+
+    LineBatch<TypeParam> batch;
+    for (const auto& line : lines)
+        batch.push_back(line);
+
+    Plane3D<TypeParam> plane{{1, 2, -1}, 3};
+
+    for (SimdLevel level : supportedLevels())
+    {
+        ASSERT_TRUE(setSimdLevel(level));
+
+        Output<TypeParam> out{lines.size()};
+        planeLineIntersect(plane, batch, out.spans());
+
+        for (std::size_t idx = 0; idx < lines.size(); ++idx)
+        {
+            Point3D<TypeParam> expected = planeLineIntersect(plane, lines[idx]);
+
+            ASSERT_EQ(out.hit[idx], expected.valid()) << "line " << idx;
+            if (expected.valid())
+            {
+                EXPECT_EQ(out.point(idx), expected) << "line " << idx;
+            }
+        }
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+TYPED_TEST(LineBatchTest, LineLineMatchesScalar)
+{
+    std::vector<Line3D<TypeParam>> lines = randomLines<TypeParam>(203, 11);
+
+    LineBatch<TypeParam> batch;
+    for (const auto& line : lines)
+        batch.push_back(line);
+
+    for (SimdLevel level : supportedLevels())
+    {
+        ASSERT_TRUE(setSimdLevel(level));
+
+        for (std::size_t query = 0; query < 20; ++query)
+        {
+            Output<TypeParam> out{lines.size()};
+            lineLineIntersect(lines[query], batch, out.spans());
+
+            for (std::size_t idx = 0; idx < lines.size(); ++idx)
+            {
+                Point3D<TypeParam> expected = lineLineIntersect(lines[query], lines[idx]);
+
+                ASSERT_EQ(out.hit[idx], expected.valid()) << "lines " << query << ", " << idx;
+                if (expected.valid())
+                {
+                    EXPECT_EQ(out.point(idx), expected) << "lines " << query << ", " << idx;
+                }
+            }
+        }
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+TYPED_TEST(LineBatchTest, InvalidQueryMissesEverything)
+{
+    LineBatch<TypeParam> batch;
+    batch.push_back(Line3D<TypeParam>{{1, 0, 0}, {0, 0, 0}});
+
+    Output<TypeParam> out{1};
+    out.hit[0] = 1;
+
+    lineLineIntersect(Line3D<TypeParam>{}, batch, out.spans());
+    EXPECT_EQ(out.hit[0], 0);
+
+    out.hit[0] = 1;
+    planeLineIntersect(Plane3D<TypeParam>{{0, 0, 0}, geometry3D::nan<TypeParam>}, batch, out.spans());
+    EXPECT_EQ(out.hit[0], 0);
+}
+
+TYPED_TEST(LineBatchTest, PlanePoint)
+{
+    Plane3D<TypeParam> plane{{0, 0, 1}, -1};
+
+    PointBatch<TypeParam> points;
+    for (int i = 0; i < 37; ++i)
+        points.push_back(Point3D<TypeParam>{TypeParam(i), TypeParam(-i), TypeParam(i % 3)});
+    points.push_back(Point3D<TypeParam>{});
+
+    for (SimdLevel level : supportedLevels())
+    {
+        ASSERT_TRUE(setSimdLevel(level));
+
+        std::vector<std::uint8_t> hit(points.size());
+        planePointIntersect(plane, points, std::span<std::uint8_t>{hit});
+
+        for (int i = 0; i < 37; ++i)
+            EXPECT_EQ(hit[i], i % 3 == 1) << "point " << i;
+        EXPECT_EQ(hit.back(), 0);
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+TYPED_TEST(LineBatchTest, ReuseAfterClear)
+{
+    Plane3D<TypeParam> plane{{0, 0, 1}, -1};
+
+    LineBatch<TypeParam> lines;
+    PointBatch<TypeParam> points;
+    for (int i = 0; i < 3; ++i)
+    {
+        lines.push_back(Line3D<TypeParam>{{1, TypeParam(i), 1}, {0, 0, 0}});
+        points.push_back(Point3D<TypeParam>{TypeParam(i), 1, 1});
+    }
+
+    lines.clear();
+    points.clear();
+
+    // the same slots again, the earlier lines cross the plane and the points are on it
+    lines.push_back(Line3D<TypeParam>{});
+    lines.push_back(Line3D<TypeParam>{{0, 0, 1}, {0, 0, geometry3D::nan<TypeParam>}});
+    points.push_back(Point3D<TypeParam>{});
+
+    for (SimdLevel level : supportedLevels())
+    {
+        ASSERT_TRUE(setSimdLevel(level));
+
+        Output<TypeParam> out{lines.size()};
+        out.hit.assign(lines.size(), 1);
+        planeLineIntersect(plane, lines, out.spans());
+        EXPECT_EQ(out.hit, (std::vector<std::uint8_t>{0, 0}));
+
+        out.hit.assign(lines.size(), 1);
+        lineLineIntersect(Line3D<TypeParam>{{0, 1, 1}, {1, 0, 0}}, lines, out.spans());
+        EXPECT_EQ(out.hit, (std::vector<std::uint8_t>{0, 0}));
+
+        std::vector<std::uint8_t> hit{1};
+        planePointIntersect(plane, points, std::span<std::uint8_t>{hit});
+        EXPECT_EQ(hit[0], 0);
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+TYPED_TEST(LineBatchTest, ShortOutputThrows)
+{
+    LineBatch<TypeParam> lines;
+    PointBatch<TypeParam> points;
+    for (int i = 0; i < 5; ++i)
+    {
+        lines.push_back(Line3D<TypeParam>{{1, TypeParam(i), 1}, {0, 0, 0}});
+        points.push_back(Point3D<TypeParam>{TypeParam(i), 0, 1});
+    }
+
+    Plane3D<TypeParam> plane{{0, 0, 1}, -1};
+    Line3D<TypeParam> query{{0, 1, 0}, {1, 0, 0}};
+
+    Output<TypeParam> out{lines.size()};
+    EXPECT_NO_THROW(planeLineIntersect(plane, lines, out.spans()));
+
+    Output<TypeParam> shortHit{lines.size()};
+    shortHit.hit.pop_back();
+    EXPECT_THROW(planeLineIntersect(plane, lines, shortHit.spans()), std::length_error);
+    EXPECT_THROW(lineLineIntersect(query, lines, shortHit.spans()), std::length_error);
+
+    Output<TypeParam> shortCoord{lines.size()};
+    shortCoord.z.pop_back();
+    EXPECT_THROW(lineLineIntersect(query, lines, shortCoord.spans()), std::length_error);
+
+    // an invalid query writes no points but still fills every hit
+    EXPECT_THROW(planeLineIntersect(Plane3D<TypeParam>{{0, 0, 0}, geometry3D::nan<TypeParam>}, lines, shortHit.spans()),
+                 std::length_error);
+
+    std::vector<std::uint8_t> hit(points.size() - 1);
+    EXPECT_THROW(planePointIntersect(plane, points, std::span<std::uint8_t>{hit}), std::length_error);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include "morton.hh"
+#include "test_helpers.hh"
+
+using namespace geometry3D;
+using namespace helpers;
+
+namespace
+{
+
+template <typename T>
+class MortonTest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(MortonTest, ScalarTypes);
+
+}
+
+TEST(MortonCodeTest, InterleavesBits)
+{
+    EXPECT_EQ(mortonCode(0, 0, 0), 0u);
+    EXPECT_EQ(mortonCode(1, 0, 0), 1u);
+    EXPECT_EQ(mortonCode(0, 1, 0), 2u);
+    EXPECT_EQ(mortonCode(0, 0, 1), 4u);
+    EXPECT_EQ(mortonCode(3, 0, 0), 9u);
+
+    constexpr std::uint32_t LAST = (1u << MORTON_BITS) - 1;
+    EXPECT_EQ(mortonCode(LAST, LAST, LAST), (std::uint64_t{1} << 63) - 1);
+
+    // bits above MORTON_BITS are dropped
+    EXPECT_EQ(mortonCode(LAST + 2, 0, 0), 1u);
+}
+
+TEST(MortonCodeTest, SortIsStable)
+{
+    std::mt19937_64 gen{3};
+    std::uniform_int_distribution<std::uint64_t> wide;
+    std::uniform_int_distribution<std::uint64_t> narrow{0, 50};
+
+    for (std::size_t size : {std::size_t{0}, std::size_t{1}, std::size_t{1000}, std::size_t{300000}})
+    {
+        std::vector<std::uint64_t> codes(size);
+        for (std::size_t idx = 0; idx < size; ++idx)
+            codes[idx] = (idx % 2 == 0) ? wide(gen) : narrow(gen);
+
+        std::vector<std::uint32_t> expected(size);
+        std::iota(expected.begin(), expected.end(), 0);
+        std::stable_sort(expected.begin(), expected.end(), [&](std::uint32_t lhs, std::uint32_t rhs)
+        {
+            return codes[lhs] < codes[rhs];
+        });
+
+        for (std::size_t threads : {1, 3, 8})
+        {
+            EXPECT_EQ(sortByCode(codes, threads), expected) << size << ' ' << threads;
+        }
+    }
+}
+
+TYPED_TEST(MortonTest, InvalidTrianglesSortLast)
+{
+    TriangleSoA<TypeParam> soa;
+    soa.push_back(Triangle3D<TypeParam>{{5, 5, 5}, {6, 5, 5}, {5, 6, 5}});
+    soa.push_back(Triangle3D<TypeParam>{{0, 0, geometry3D::nan<TypeParam>}, {1, 0, 0}, {0, 1, 0}});
+    soa.push_back(Triangle3D<TypeParam>{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}});
+
+    std::vector<std::uint64_t> codes = mortonCodes(soa);
+    EXPECT_EQ(codes[0], mortonCode((1u << MORTON_BITS) - 1, (1u << MORTON_BITS) - 1, (1u << MORTON_BITS) - 1));
+    EXPECT_EQ(codes[1], std::numeric_limits<std::uint64_t>::max());
+    EXPECT_EQ(codes[2], 0u);
+
+    MortonSorted<TypeParam> sorted = mortonSort(soa);
+    EXPECT_EQ(sorted.original, (std::vector<std::uint32_t>{2, 0, 1}));
+    EXPECT_EQ(sorted.triangles.coord(0, X)[1], 5);
+    EXPECT_TRUE(std::isnan(sorted.triangles.coord(0, Z)[2]));
+}
+
+TYPED_TEST(MortonTest, CoordinatesNearTheLimit)
+{
+    constexpr TypeParam BIG = std::numeric_limits<TypeParam>::max();
+    constexpr std::uint32_t LAST = (1u << MORTON_BITS) - 1;
+
+    // sums of the vertices and the extent of the centroids would overflow
+    TriangleSoA<TypeParam> soa;
+    soa.push_back(Triangle3D<TypeParam>{{-BIG, -BIG, -BIG}, {-BIG, -BIG, -BIG}, {-BIG, -BIG, -BIG}});
+    soa.push_back(Triangle3D<TypeParam>{{BIG, BIG, BIG}, {BIG, BIG, BIG}, {BIG, BIG, BIG}});
+    soa.push_back(Triangle3D<TypeParam>{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}});
+
+    std::vector<std::uint64_t> codes = mortonCodes(soa);
+    EXPECT_EQ(codes[0], 0u);
+    EXPECT_LT(codes[2], codes[1]);
+    EXPECT_GT(codes[2], 0u);
+    EXPECT_LE(codes[1], mortonCode(LAST, LAST, LAST));
+
+    std::vector<Triangle3D<TypeParam>> triangles{soa[0], soa[1], soa[2]};
+    EXPECT_EQ(mortonCodes(std::span<const Triangle3D<TypeParam>>{triangles}), codes);
+
+    // an extent too small to invert
+    constexpr TypeParam TINY = 64 * std::numeric_limits<TypeParam>::denorm_min();
+
+    TriangleSoA<TypeParam> close;
+    close.push_back(Triangle3D<TypeParam>{{0, 0, 0}, {0, 0, 0}, {0, 0, 0}});
+    close.push_back(Triangle3D<TypeParam>{{TINY, TINY, TINY}, {TINY, TINY, TINY}, {TINY, TINY, TINY}});
+
+    EXPECT_EQ(mortonCodes(close), (std::vector<std::uint64_t>{0, mortonCode(LAST, LAST, LAST)}));
+}
+
+TYPED_TEST(MortonTest, SortedTrianglesGiveSameResult)
+{
+    TriangleSoA<TypeParam> soa = toSoA(randomTriangles<TypeParam>(2000, 7, 20));
+
+    std::vector<Triangle3D<TypeParam>> triangles;
+    for (std::size_t idx = 0; idx < soa.size(); ++idx)
+        triangles.push_back(soa[idx]);
+
+    EXPECT_EQ(mortonCodes(soa, 3), mortonCodes(std::span<const Triangle3D<TypeParam>>{triangles}, 1));
+
+    MortonSorted<TypeParam> sorted = mortonSort(soa, 3);
+
+    std::vector<std::uint32_t> original = sorted.original;
+    std::sort(original.begin(), original.end());
+    for (std::size_t idx = 0; idx < original.size(); ++idx)
+    {
+        ASSERT_EQ(original[idx], idx);
+    }
+
+    std::vector<std::uint64_t> codes = mortonCodes(sorted.triangles);
+    EXPECT_TRUE(std::is_sorted(codes.begin(), codes.end()));
+
+    EXPECT_EQ(sorted.originalIndices(intersectingTriangles(sorted.triangles)), intersectingTriangles(soa));
+}
@@ -4,11 +4,51 @@
 
 TEST(PlaneLineCross, Test1)
 {
-    geometry3D::Plane3D plane{{0, 0, 1}, 0};
-    geometry3D::Line3D line{{0, 0, 1}, {1, 1, 0}};
+    geometry3D::Plane3D<double> plane{{0, 0, 1}, 0};
+    geometry3D::Line3D<double> line{{0, 0, 1}, {1, 1, 0}};
 
-    geometry3D::Point3D point = planeLineIntersect(plane, line);
-    geometry3D::Point3D expectedPoint{1, 1, 0};
+    geometry3D::Point3D<double> point = planeLineIntersect(plane, line);
+    geometry3D::Point3D<double> expectedPoint{1, 1, 0};
 
     ASSERT_EQ(point, expectedPoint);
-}
\ No newline at end of file
+}
+
+TEST(VectorAlgebra, Constexpr)
+{
+    using Vector = geometry3D::Vector3D<float>;
+
+    constexpr Vector cross = Vector{1, 0, 0}.crossProduct(Vector{0, 1, 0});
+    static_assert(cross == Vector{0, 0, 1});
+    static_assert((Vector{1, 2, 3} + Vector{1, 1, 1}).scalarProduct(Vector{1, 0, 0}) == 2);
+
+    constexpr geometry3D::Point3D<double> invalid{};
+    static_assert(!invalid.valid());
+
+    EXPECT_EQ(cross, (Vector{0, 0, 1}));
+}
+
+TEST(PlanePoint, FreeCoefficient)
+{
+    geometry3D::Plane3D<double> plane{{0, 0, 1}, -1};
+
+    EXPECT_TRUE(planePointIntersect(plane, geometry3D::Point3D<double>{5, 3, 1}));
+    EXPECT_FALSE(planePointIntersect(plane, geometry3D::Point3D<double>{5, 3, 0}));
+}
+
+TEST(PlaneLineCross, OffsetPlane)
+{
+    geometry3D::Plane3D<double> plane{{0, 0, 1}, -2};
+    geometry3D::Line3D<double> line{{1, 0, 1}, {0, 0, 0}};
+
+    EXPECT_EQ(planeLineIntersect(plane, line), (geometry3D::Point3D<double>{2, 0, 2}));
+}
+
+TEST(LineLineCross, Skew)
+{
+    geometry3D::Line3D<double> lhs{{1, 0, 0}, {0, 1, 0}};
+    geometry3D::Line3D<double> rhs{{0, 1, 0}, {2, 0, 0}};
+    geometry3D::Line3D<double> above{{0, 1, 0}, {2, 0, 1}};
+
+    EXPECT_EQ(lineLineIntersect(lhs, rhs), (geometry3D::Point3D<double>{2, 1, 0}));
+    EXPECT_FALSE(lineLineIntersect(lhs, above).valid());
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "predicates.hh"
+
+using namespace geometry3D;
+
+namespace
+{
+
+int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+}
+
+// points a few ulps off the line y = x, where naive evaluation gives inconsistent signs
+TEST(Predicates, Orient2dNearCollinear)
+{
+    for (int i = 0; i < 64; ++i)
+        for (int j = 0; j < 64; ++j)
+        {
+            double x = 0.5 + i * std::ldexp(1.0, -53);
+            double y = 0.5 + j * std::ldexp(1.0, -53);
+
+            EXPECT_EQ(orient2d(12, 12, 24, 24, x, y), sign(j - i)) << i << " " << j;
+        }
+}
+
+TEST(Predicates, Orient3dNearCoplanar)
+{
+    Point3D<double> a{12, 12, 0};
+    Point3D<double> b{24, 24, 0};
+    Point3D<double> c{0, 0, 1};
+
+    for (int i = 0; i < 64; ++i)
+        for (int j = 0; j < 64; ++j)
+        {
+            Point3D<double> d{0.5 + i * std::ldexp(1.0, -53), 0.5 + j * std::ldexp(1.0, -53), 0.5};
+
+            // (a - d) * ((b - d) x (c - d)) = 12 * (d.y - d.x) for this plane
+            EXPECT_EQ(orient3d(a, b, c, d), sign(j - i)) << i << " " << j;
+        }
+}
+
+TEST(Predicates, Orientation)
+{
+    EXPECT_EQ(orient2d(0, 0, 1, 0, 0, 1), 1);
+    EXPECT_EQ(orient2d(0, 0, 0, 1, 1, 0), -1);
+
+    Point3D<float> a{0, 0, 0}, b{1, 0, 0}, c{0, 1, 0};
+
+    EXPECT_EQ(orient3d(a, b, c, Point3D<float>{0, 0, -1}), 1);
+    EXPECT_EQ(orient3d(a, b, c, Point3D<float>{0, 0, 1}), -1);
+    EXPECT_EQ(orient3d(a, b, c, Point3D<float>{5, 7, 0}), 0);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include "ray_query.hh"
+#include "test_helpers.hh"
+#include "triangle_soa.hh"
+
+using namespace geometry3D;
+using namespace helpers;
+
+namespace
+{
+
+// random triangles with the special ones and one with an invalid vertex
+template <typename T>
+std::vector<Triangle3D<T>> sceneTriangles(unsigned seed)
+{
+    std::vector<Triangle3D<T>> triangles = randomTriangles<T>(500, seed);
+    appendSpecialTriangles(triangles);
+    triangles.push_back(Triangle3D<T>{{1, 1, 1}, {2, 2, 2}, {}});
+
+    return triangles;
+}
+
+template <typename T>
+std::vector<Ray3D<T>> gridRays(std::size_t side)
+{
+    std::vector<Ray3D<T>> rays;
+    Point3D<T> origin{-5, 5, 5};
+
+    for (std::size_t row = 0; row < side; ++row)
+        for (std::size_t col = 0; col < side; ++col)
+        {
+            Vector3D<T> direction{T(15), T(10) * row / side - 5, T(10) * col / side - 5};
+            rays.push_back(Ray3D<T>{origin, direction});
+        }
+
+    rays.push_back(Ray3D<T>{origin, Vector3D<T>{1, 0, 0}, 0, T(0.1)});
+    rays.push_back(Ray3D<T>{});
+
+    return rays;
+}
+
+template <typename T>
+RayHit<T> bruteForceClosest(const std::vector<Triangle3D<T>>& triangles, const Ray3D<T>& ray)
+{
+    RayHit<T> closest;
+
+    for (std::size_t idx = 0; idx < triangles.size(); ++idx)
+    {
+        RayHit<T> hit = rayTriangleIntersect(ray, triangles[idx]);
+        if (hit.valid() && (!closest.valid() || hit.t < closest.t))
+        {
+            closest = hit;
+            closest.triangle = idx;
+        }
+    }
+
+    return closest;
+}
+
+template <typename T>
+class RayQueryTest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(RayQueryTest, ScalarTypes);
+
+}
+
+TYPED_TEST(RayQueryTest, MollerTrumbore)
+{
+    Triangle3D<TypeParam> tr{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}};
+
+    RayHit<TypeParam> hit = rayTriangleIntersect(Ray3D<TypeParam>{{0.5, 0.5, 1}, {0, 0, -2}}, tr);
+    ASSERT_TRUE(hit.valid());
+    EXPECT_FLOAT_EQ(hit.t, 0.5);
+    EXPECT_FLOAT_EQ(hit.u, 0.25);
+    EXPECT_FLOAT_EQ(hit.v, 0.25);
+
+    EXPECT_FALSE(rayTriangleIntersect(Ray3D<TypeParam>{{0.5, 0.5, 1}, {0, 0, 1}}, tr).valid());
+    EXPECT_FALSE(rayTriangleIntersect(Ray3D<TypeParam>{{3, 3, 1}, {0, 0, -1}}, tr).valid());
+    EXPECT_FALSE(rayTriangleIntersect(Ray3D<TypeParam>{{0.5, 0.5, 1}, {1, 0, 0}}, tr).valid());
+    EXPECT_FALSE(rayTriangleIntersect(Ray3D<TypeParam>{{0.5, 0.5, 1}, {0, 0, -1}, 0, 0.5}, tr).valid());
+}
+
+TYPED_TEST(RayQueryTest, SingleRayMatchesBruteForce)
+{
+    std::vector<Triangle3D<TypeParam>> triangles = sceneTriangles<TypeParam>(5);
+    std::vector<Ray3D<TypeParam>> rays = gridRays<TypeParam>(30);
+
+    RayScene<TypeParam> scene{triangles};
+    EXPECT_EQ(scene.size(), triangles.size() - 1);
+
+    for (const auto& ray : rays)
+    {
+        RayHit<TypeParam> expected = bruteForceClosest(triangles, ray);
+        RayHit<TypeParam> hit = scene.closestHit(ray);
+
+        ASSERT_EQ(hit.valid(), expected.valid());
+        EXPECT_EQ(scene.anyHit(ray), expected.valid());
+
+        std::vector<RayHit<TypeParam>> all = scene.allHits(ray);
+        std::size_t count = 0;
+        for (const auto& tr : triangles)
+            count += rayTriangleIntersect(ray, tr).valid();
+        EXPECT_EQ(all.size(), count);
+
+        if (expected.valid())
+        {
+            EXPECT_EQ(hit.triangle, expected.triangle);
+            EXPECT_EQ(hit.t, expected.t);
+            EXPECT_EQ(all.front().t, expected.t);
+        }
+    }
+}
+
+TYPED_TEST(RayQueryTest, PacketsMatchSingleRays)
+{
+    std::vector<Triangle3D<TypeParam>> triangles = sceneTriangles<TypeParam>(9);
+    std::vector<Ray3D<TypeParam>> rays = gridRays<TypeParam>(41);
+
+    RayScene<TypeParam> scene{triangles};
+
+    for (SimdLevel level : supportedLevels())
+    {
+        ASSERT_TRUE(setSimdLevel(level));
+
+        std::vector<RayHit<TypeParam>> hits(rays.size());
+        std::vector<std::uint8_t> any(rays.size());
+
+        scene.closestHit(rays, hits);
+        scene.anyHit(rays, any);
+
+        for (std::size_t idx = 0; idx < rays.size(); ++idx)
+        {
+            RayHit<TypeParam> expected = scene.closestHit(rays[idx]);
+
+            ASSERT_EQ(hits[idx].valid(), expected.valid()) << "ray " << idx;
+            EXPECT_EQ(any[idx], expected.valid()) << "ray " << idx;
+
+            if (expected.valid())
+            {
+                EXPECT_EQ(hits[idx].triangle, expected.triangle) << "ray " << idx;
+                EXPECT_NEAR(hits[idx].t, expected.t, 10 * EPS<TypeParam>) << "ray " << idx;
+                EXPECT_NEAR(hits[idx].u, expected.u, 10 * EPS<TypeParam>) << "ray " << idx;
+                EXPECT_NEAR(hits[idx].v, expected.v, 10 * EPS<TypeParam>) << "ray " << idx;
+            }
+        }
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+TYPED_TEST(RayQueryTest, EmptyScene)
+{
+    RayScene<TypeParam> scene{std::vector<Triangle3D<TypeParam>>{}};
+    Ray3D<TypeParam> ray{{0, 0, 0}, {1, 0, 0}};
+
+    EXPECT_FALSE(scene.closestHit(ray).valid());
+    EXPECT_FALSE(scene.anyHit(ray));
+    EXPECT_TRUE(scene.allHits(ray).empty());
+
+    std::vector<RayHit<TypeParam>> hits(1);
+    scene.closestHit(std::span<const Ray3D<TypeParam>>{&ray, 1}, hits);
+    EXPECT_FALSE(hits[0].valid());
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <type_traits>
+
+#include "test_helpers.hh"
+#include "triangle_soa.hh"
+
+using namespace geometry3D;
+using namespace helpers;
+
+namespace
+{
+
+// every stage may only reject what the exact test rejects
+template <typename T>
+void expectBatchMatchesScalar(const TriangleSoA<T>& soa, SimdLevel level)
+{
+    std::size_t size = soa.size();
+    std::vector<std::uint8_t> aabb(size), side(size), hit(size);
+
+    for (std::size_t query = 0; query < size; query += 7)
+    {
+        // odd begin to exercise unaligned loads and partial tails
+        std::size_t begin = query % 3;
+
+        aabbOverlap(soa[query], soa, begin, size, aabb.data());
+        planeSideTest(soa[query], soa, begin, size, side.data());
+        triangleBatchIntersect(soa[query], soa, begin, size, hit.data());
+
+        for (std::size_t idx = begin; idx < size; ++idx)
+        {
+            bool expected = triangleTriangleIntersect(soa[query], soa[idx]);
+
+            EXPECT_EQ(hit[idx - begin], expected) << "level " << static_cast<int>(level) << ", pair " << query << ' ' << idx;
+            if (expected)
+            {
+                EXPECT_TRUE(aabb[idx - begin]);
+                EXPECT_TRUE(side[idx - begin]);
+            }
+        }
+    }
+}
+
+template <typename T>
+class TriangleSoATest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(TriangleSoATest, ScalarTypes);
+
+}
+
+TYPED_TEST(TriangleSoATest, RoundTrip)
+{
+    Triangle3D<TypeParam> tr{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+
+    TriangleSoA<TypeParam> soa;
+    soa.push_back(tr);
+
+    ASSERT_EQ(soa.size(), 1);
+    for (int vertex = 0; vertex < 3; ++vertex)
+        EXPECT_EQ(soa[0][vertex], tr[vertex]);
+}
+
+TYPED_TEST(TriangleSoATest, BatchMatchesScalar)
+{
+    std::vector<Triangle3D<TypeParam>> triangles = randomTriangles<TypeParam>(200, 42);
+    appendSpecialTriangles(triangles);
+    TriangleSoA<TypeParam> soa = toSoA(triangles);
+
+    for (SimdLevel level : supportedLevels())
+    {
+        ASSERT_TRUE(setSimdLevel(level));
+        expectBatchMatchesScalar(soa, level);
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+// rounding of the plane side stages grows with the coordinates, while the triangles stay small
+TYPED_TEST(TriangleSoATest, BatchMatchesScalarFarFromOrigin)
+{
+    std::vector<TypeParam> origins = std::is_same_v<TypeParam, float> ? std::vector<TypeParam>{1e3f, 1e4f}
+                                                                      : std::vector<TypeParam>{1e9};
+
+    for (TypeParam origin : origins)
+    {
+        Point3D<TypeParam> corner{origin, origin, origin};
+        std::vector<Triangle3D<TypeParam>> triangles = randomTriangles<TypeParam>(400, 17, 10, corner);
+        appendSpecialTriangles(triangles, corner);
+        TriangleSoA<TypeParam> soa = toSoA(triangles);
+
+        for (SimdLevel level : supportedLevels())
+        {
+            ASSERT_TRUE(setSimdLevel(level));
+            expectBatchMatchesScalar(soa, level);
+        }
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+TYPED_TEST(TriangleSoATest, IntersectingTriangles)
+{
+    TriangleSoA<TypeParam> soa;
+    soa.push_back(Triangle3D<TypeParam>{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}});
+    soa.push_back(Triangle3D<TypeParam>{{10, 10, 10}, {11, 10, 10}, {10, 11, 10}});
+    soa.push_back(Triangle3D<TypeParam>{{0.5, 0.5, -1}, {0.5, 0.5, 1}, {3, 3, 0}});
+
+    EXPECT_EQ(intersectingTriangles(soa), (std::vector<std::size_t>{0, 2}));
+}
+
+// a few thousand units away the float pipeline used to drop touching pairs its own exact test accepts
+TEST(TriangleSoAFloatTest, IntersectingTrianglesFarFromOrigin)
+{
+    Point3D<float> corner{4096, 4096, 4096};
+    std::vector<Triangle3D<float>> triangles = randomTriangles<float>(200, 5, 10, corner);
+    appendSpecialTriangles(triangles, corner);
+
+    // folds sharing an edge with every triangle touch it only along the edge
+    std::mt19937 gen{5};
+    std::uniform_real_distribution<float> offset{-1, 1};
+
+    std::size_t size = triangles.size();
+    for (std::size_t idx = 0; idx < size; ++idx)
+    {
+        Triangle3D<float> tr = triangles[idx];
+        Point3D<float> apex{tr[2].coords[X] + offset(gen), tr[2].coords[Y] + offset(gen), tr[2].coords[Z] + offset(gen)};
+        triangles.push_back(Triangle3D<float>{tr[0], tr[1], apex});
+    }
+
+    TriangleSoA<float> soa = toSoA(triangles);
+    size = soa.size();
+
+    std::vector<bool> intersecting(size);
+    for (std::size_t first = 0; first < size; ++first)
+        for (std::size_t second = first + 1; second < size; ++second)
+            if (triangleTriangleIntersect(soa[first], soa[second]))
+                intersecting[first] = intersecting[second] = true;
+
+    std::vector<std::size_t> expected;
+    for (std::size_t idx = 0; idx < size; ++idx)
+        if (intersecting[idx])
+            expected.push_back(idx);
+
+    for (SimdLevel level : supportedLevels())
+    {
+        ASSERT_TRUE(setSimdLevel(level));
+        EXPECT_EQ(intersectingTriangles(soa), expected) << "level " << static_cast<int>(level);
+    }
+
+    setSimdLevel(detectSimdLevel());
+}
+
+TYPED_TEST(TriangleSoATest, PipelineStats)
+{
+    std::vector<Triangle3D<TypeParam>> triangles = randomTriangles<TypeParam>(300, 11);
+    appendSpecialTriangles(triangles);
+    TriangleSoA<TypeParam> soa = toSoA(triangles);
+    std::size_t size = soa.size();
+
+    PipelineStats stats;
+    EXPECT_EQ(intersectingTriangles(soa, stats), intersectingTriangles(soa));
+
+    std::uint64_t candidates = 0, intersecting = 0;
+    for (std::size_t first = 0; first < size; ++first)
+        for (std::size_t second = first + 1; second < size; ++second)
+        {
+            candidates += soa[first].box().overlaps(soa[second].box());
+            intersecting += triangleTriangleIntersect(soa[first], soa[second]);
+        }
+
+    EXPECT_EQ(stats.pairs, size * (size - 1) / 2);
+    EXPECT_EQ(stats.candidates, candidates);
+    EXPECT_EQ(stats.intersectingPairs, intersecting);
+
+    EXPECT_LE(stats.planeSidePassed, stats.candidates);
+    EXPECT_LE(stats.reversePlaneSidePassed, stats.planeSidePassed);
+    EXPECT_LE(stats.intersectingPairs, stats.reversePlaneSidePassed);
+
+    // the filters already reject every pair of disjoint boxes
+    EXPECT_EQ(stats.exactDecided[static_cast<std::size_t>(TriangleTestStage::Boxes)], 0);
+    EXPECT_GT(stats.exactDecided[static_cast<std::size_t>(TriangleTestStage::Intervals)], 0);
+    EXPECT_GT(stats.exactTime.count(), 0);
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+#include "tiled_intersection.hh"
+#include "triangle_io.hh"
+
+using namespace geometry3D;
+
+namespace
+{
+
+// removes the file when the test ends
+struct TempFile
+{
+    std::string path;
+
+    TempFile(const std::string& name, const std::string& content) : path(::testing::TempDir() + name)
+    {
+        std::ofstream{path, std::ios::binary} << content;
+    }
+
+    ~TempFile()
+    {
+        std::remove(path.c_str());
+    }
+};
+
+// small triangles, most of them in a dense cluster, and a few long ones crossing many tiles
+std::vector<float> randomSoup(std::size_t count, unsigned seed)
+{
+    std::mt19937 gen{seed};
+    std::uniform_real_distribution<float> wide{0, 100};
+    std::uniform_real_distribution<float> dense{40, 45};
+    std::uniform_real_distribution<float> offset{-1, 1};
+
+    std::vector<float> coords;
+
+    for (std::size_t tr = 0; tr < count; ++tr)
+    {
+        bool clustered = tr % 3 != 0;
+        bool spanning = tr % 97 == 0;
+
+        float center[3];
+        for (float& coord : center)
+            coord = clustered ? dense(gen) : wide(gen);
+
+        for (int vertex = 0; vertex < 3; ++vertex)
+            for (int axis = 0; axis < 3; ++axis)
+                coords.push_back(center[axis] + offset(gen) * (spanning ? 30.0f : 1.0f));
+    }
+
+    return coords;
+}
+
+std::string text(const std::vector<float>& coords)
+{
+    std::ostringstream out;
+    out.precision(9);
+
+    out << coords.size() / 9 << '\n';
+    for (float coord : coords)
+        out << coord << ' ';
+
+    return out.str();
+}
+
+std::string stl(const std::vector<float>& coords)
+{
+    std::string bytes(StlView::HEADER_SIZE, '\0');
+
+    std::uint32_t count = static_cast<std::uint32_t>(coords.size() / 9);
+    std::memcpy(bytes.data() + 80, &count, sizeof(count));
+
+    for (std::size_t tr = 0; tr < count; ++tr)
+    {
+        float normal[3] = {};
+        bytes.append(reinterpret_cast<const char*>(normal), sizeof(normal));
+        bytes.append(reinterpret_cast<const char*>(coords.data() + 9 * tr), 9 * sizeof(float));
+        bytes.append(2, '\0');
+    }
+
+    return bytes;
+}
+
+std::vector<bool> flags(std::size_t size, const std::vector<std::size_t>& indices)
+{
+    std::vector<bool> result(size, false);
+    for (std::size_t idx : indices)
+        result[idx] = true;
+
+    return result;
+}
+
+template <typename T>
+class TiledIntersectionTest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(TiledIntersectionTest, ScalarTypes);
+
+}
+
+TYPED_TEST(TiledIntersectionTest, MatchesInMemoryEngine)
+{
+    std::vector<float> coords = randomSoup(1500, 5);
+
+    TempFile textFile{"soup.txt", text(coords)};
+    TempFile stlFile{"soup.stl", stl(coords)};
+
+    std::vector<bool> expected = flags(1500, intersectingTriangles(loadTriangles<TypeParam>(textFile.path)));
+    ASSERT_EQ(expected, flags(1500, intersectingTriangles(loadStl<TypeParam>(stlFile.path))));
+
+    // everything in one tile, a few hundred triangles per tile and a tile for every occupied grid cell
+    for (std::size_t budget : {std::size_t{1} << 30, std::size_t{4} << 20, std::size_t{0}})
+    {
+        TilingOptions options;
+        options.memoryBudget = budget;
+        options.scratchDirectory = ::testing::TempDir();
+
+        EXPECT_EQ(intersectingTrianglesOutOfCore<TypeParam>(textFile.path, options), expected) << budget;
+        EXPECT_EQ(intersectingTrianglesOutOfCore<TypeParam>(stlFile.path, options), expected) << budget;
+    }
+}
+
+TYPED_TEST(TiledIntersectionTest, InvalidAndEmptyInput)
+{
+    TempFile empty{"empty.txt", "0"};
+    EXPECT_TRUE(intersectingTrianglesOutOfCore<TypeParam>(empty.path).empty());
+
+    TempFile invalid{"invalid.txt", "3\n"
+                                    "0 0 0  1 0 0  0 1 0\n"
+                                    "0.2 0.2 -1  0.2 0.2 1  5 5 nan\n"
+                                    "0.2 0.2 -1  0.2 0.2 1  5 5 0\n"};
+
+    EXPECT_EQ(intersectingTrianglesOutOfCore<TypeParam>(invalid.path), (std::vector<bool>{true, false, true}));
+}
+
+TYPED_TEST(TiledIntersectionTest, CoordinatesNearTheLimit)
+{
+    // sums of the vertices and the extent of the centroids would overflow in float
+    TempFile huge{"huge.txt", "4\n"
+                              "-3.4e38 -3.4e38 -3.4e38  -3.3e38 -3.4e38 -3.4e38  -3.4e38 -3.3e38 -3.4e38\n"
+                              "3.4e38 3.4e38 3.4e38  3.3e38 3.4e38 3.4e38  3.4e38 3.3e38 3.4e38\n"
+                              "0 0 0  1 0 0  0 1 0\n"
+                              "0.2 0.2 -1  0.2 0.2 1  5 5 0\n"};
+
+    TilingOptions options;
+    options.memoryBudget = 0;
+    options.scratchDirectory = ::testing::TempDir();
+
+    EXPECT_EQ(intersectingTrianglesOutOfCore<TypeParam>(huge.path, options),
+              (std::vector<bool>{false, false, true, true}));
+}
+
+TYPED_TEST(TiledIntersectionTest, ReportsErrors)
+{
+    EXPECT_THROW(intersectingTrianglesOutOfCore<TypeParam>(::testing::TempDir() + "missing.stl"), std::system_error);
+
+    TempFile malformed{"malformed.txt", "2\n0 0 0 1 0 0 0 1 0"};
+    EXPECT_THROW(intersectingTrianglesOutOfCore<TypeParam>(malformed.path), std::runtime_error);
+
+    TempFile valid{"valid.txt", "1\n0 0 0 1 0 0 0 1 0"};
+    TilingOptions options;
+    options.scratchDirectory = ::testing::TempDir() + "missing-directory";
+
+    EXPECT_THROW(intersectingTrianglesOutOfCore<TypeParam>(valid.path, options), std::system_error);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "triangle_io.hh"
+
+using namespace geometry3D;
+
+namespace
+{
+
+template <typename T>
+void expectSame(const TriangleSoA<T>& lhs, const TriangleSoA<T>& rhs)
+{
+    ASSERT_EQ(lhs.size(), rhs.size());
+
+    for (std::size_t idx = 0; idx < lhs.size(); ++idx)
+        for (int vertex = 0; vertex < 3; ++vertex)
+            for (int axis = 0; axis < 3; ++axis)
+                ASSERT_EQ(lhs.coord(vertex, static_cast<Axis>(axis))[idx], rhs.coord(vertex, static_cast<Axis>(axis))[idx]);
+}
+
+// removes the file when the test ends
+struct TempFile
+{
+    std::string path;
+
+    TempFile(const std::string& name, const std::string& content) : path(::testing::TempDir() + name)
+    {
+        std::ofstream{path, std::ios::binary} << content;
+    }
+
+    ~TempFile()
+    {
+        std::remove(path.c_str());
+    }
+};
+
+template <typename T>
+class TriangleIOTest : public ::testing::Test
+{};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(TriangleIOTest, ScalarTypes);
+
+}
+
+TYPED_TEST(TriangleIOTest, ParsesText)
+{
+    TriangleSoA<TypeParam> soa = parseTriangles<TypeParam>("2\n0 0 0  1 0 0  0 1 0\n"
+                                                           "-1.5 +2 3e1\t4 5 6\r\n7 8 9");
+
+    ASSERT_EQ(soa.size(), 2);
+    EXPECT_EQ(soa[0][1], (Point3D<TypeParam>{1, 0, 0}));
+    EXPECT_EQ(soa[1][0], (Point3D<TypeParam>{-1.5, 2, 30}));
+    EXPECT_EQ(soa[1][2], (Point3D<TypeParam>{7, 8, 9}));
+}
+
+TYPED_TEST(TriangleIOTest, ChunksAgree)
+{
+    std::mt19937 gen{17};
+    std::uniform_real_distribution<double> coord{-100, 100};
+
+    std::ostringstream text;
+    text.precision(10);
+    text << 1000 << '\n';
+    for (int i = 0; i < 9000; ++i)
+        text << coord(gen) << ((i % 9 == 8) ? "\n" : "   ");
+
+    TriangleSoA<TypeParam> single = parseTriangles<TypeParam>(text.str(), 1);
+
+    for (std::size_t chunks : {2, 7, 64})
+        expectSame(single, parseTriangles<TypeParam>(text.str(), chunks));
+}
+
+TYPED_TEST(TriangleIOTest, RejectsMalformedText)
+{
+    EXPECT_THROW(parseTriangles<TypeParam>(""), std::runtime_error);
+    EXPECT_THROW(parseTriangles<TypeParam>("1\n0 0 0 1 0 0 0 1"), std::runtime_error);
+    EXPECT_THROW(parseTriangles<TypeParam>("1\n0 0 0 1 0 0 0 1 0 5"), std::runtime_error);
+    EXPECT_THROW(parseTriangles<TypeParam>("1\n0 0 0 1 0 0 0 1 x", 3), std::runtime_error);
+    EXPECT_THROW(parseTriangles<TypeParam>("1\n0 0 0 1,0 0 0 0 1 0"), std::runtime_error);
+    EXPECT_THROW(parseTriangles<TypeParam>("-1\n"), std::runtime_error);
+}
+
+TYPED_TEST(TriangleIOTest, TextReaderMatchesParser)
+{
+    std::string text = "3\n0 0 0  1 0 0  0 1 0\n-1.5 +2 3e1\t4 5 6\r\n7 8 9\n1 1 1 2 2 2 3 3 3\n";
+    TriangleSoA<TypeParam> soa = parseTriangles<TypeParam>(text);
+
+    TriangleTextReader<TypeParam> reader{text};
+    ASSERT_EQ(reader.size(), 3);
+
+    Triangle3D<TypeParam> tr{{}, {}, {}};
+    for (std::size_t idx = 0; idx < soa.size(); ++idx)
+    {
+        ASSERT_TRUE(reader.next(tr));
+        for (int vertex = 0; vertex < 3; ++vertex)
+            EXPECT_EQ(tr[vertex], soa[idx][vertex]);
+    }
+
+    EXPECT_FALSE(reader.next(tr));
+}
+
+TYPED_TEST(TriangleIOTest, TextReaderRejectsMalformedText)
+{
+    Triangle3D<TypeParam> tr{{}, {}, {}};
+
+    EXPECT_THROW(TriangleTextReader<TypeParam>{""}, std::runtime_error);
+
+    TriangleTextReader<TypeParam> missing{"1\n0 0 0 1 0 0 0 1"};
+    EXPECT_THROW(missing.next(tr), std::runtime_error);
+
+    TriangleTextReader<TypeParam> extra{"1\n0 0 0 1 0 0 0 1 0 5"};
+    EXPECT_TRUE(extra.next(tr));
+    EXPECT_THROW(extra.next(tr), std::runtime_error);
+
+    TriangleTextReader<TypeParam> invalid{"1\n0 0 0 1,0 0 0 0 1 0"};
+    EXPECT_THROW(invalid.next(tr), std::runtime_error);
+}
+
+TYPED_TEST(TriangleIOTest, LoadsFiles)
+{
+    TempFile text{"triangles.txt", "1 0 0 0 1 0 0 0 1 0"};
+    TriangleSoA<TypeParam> soa = loadTriangles<TypeParam>(text.path);
+
+    ASSERT_EQ(soa.size(), 1);
+    EXPECT_EQ(soa[0][2], (Point3D<TypeParam>{0, 1, 0}));
+
+    EXPECT_THROW(loadTriangles<TypeParam>(text.path + ".missing"), std::system_error);
+}
+
+TYPED_TEST(TriangleIOTest, BinaryStl)
+{
+    std::string bytes(StlView::HEADER_SIZE, '\0');
+    std::uint32_t count = 2;
+    std::memcpy(bytes.data() + 80, &count, sizeof(count));
+
+    for (std::uint32_t tr = 0; tr < count; ++tr)
+    {
+        float record[12] = {0, 0, 1};
+        for (int i = 3; i < 12; ++i)
+            record[i] = static_cast<float>(10 * tr + i);
+
+        bytes.append(reinterpret_cast<const char*>(record), sizeof(record));
+        bytes.append(2, '\0');
+    }
+
+    StlView view{bytes};
+    ASSERT_EQ(view.size(), 2);
+    EXPECT_EQ(view[1][0], (Point3D<float>{13, 14, 15}));
+
+    TempFile stl{"triangles.stl", bytes};
+    TriangleSoA<TypeParam> soa = loadStl<TypeParam>(stl.path, 2);
+
+    ASSERT_EQ(soa.size(), 2);
+    EXPECT_EQ(soa[0][0], (Point3D<TypeParam>{3, 4, 5}));
+    EXPECT_EQ(soa[1][2], (Point3D<TypeParam>{19, 20, 21}));
+
+    EXPECT_THROW(StlView{std::string_view{bytes}.substr(0, bytes.size() - 1)}, std::runtime_error);
+    EXPECT_THROW(StlView{"solid"}, std::runtime_error);
+}
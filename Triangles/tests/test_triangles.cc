@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "geometry3D.hh"
+
+template <typename T>
+class TriangleTriangle : public ::testing::Test
+{
+protected:
+    using Triangle3D = geometry3D::Triangle3D<T>;
+};
+
+using ScalarTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(TriangleTriangle, ScalarTypes);
+
+TYPED_TEST(TriangleTriangle, Crossing)
+{
+    typename TestFixture::Triangle3D first{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}};
+    typename TestFixture::Triangle3D second{{0.5, 0.5, -1}, {0.5, 0.5, 1}, {3, 3, 0}};
+
+    EXPECT_TRUE(triangleTriangleIntersect(first, second));
+    EXPECT_TRUE(triangleTriangleIntersect(second, first));
+}
+
+TYPED_TEST(TriangleTriangle, Separated)
+{
+    typename TestFixture::Triangle3D first{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    typename TestFixture::Triangle3D second{{0, 0, 1}, {1, 0, 1}, {0, 1, 1}};
+
+    EXPECT_FALSE(triangleTriangleIntersect(first, second));
+}
+
+TYPED_TEST(TriangleTriangle, PlanesCrossTrianglesDoNot)
+{
+    typename TestFixture::Triangle3D first{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    typename TestFixture::Triangle3D second{{5, 5, -1}, {5, 5, 1}, {6, 5, 0}};
+
+    EXPECT_FALSE(triangleTriangleIntersect(first, second));
+}
+
+TYPED_TEST(TriangleTriangle, TouchingVertex)
+{
+    typename TestFixture::Triangle3D first{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    typename TestFixture::Triangle3D second{{1, 0, 0}, {2, 0, 1}, {2, 1, 1}};
+
+    EXPECT_TRUE(triangleTriangleIntersect(first, second));
+}
+
+TYPED_TEST(TriangleTriangle, Coplanar)
+{
+    typename TestFixture::Triangle3D first{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}};
+    typename TestFixture::Triangle3D overlapping{{1, 1, 0}, {3, 1, 0}, {1, 3, 0}};
+    typename TestFixture::Triangle3D inside{{0.1, 0.1, 0}, {0.5, 0.1, 0}, {0.1, 0.5, 0}};
+    typename TestFixture::Triangle3D apart{{3, 3, 0}, {4, 3, 0}, {3, 4, 0}};
+
+    EXPECT_TRUE(triangleTriangleIntersect(first, overlapping));
+    EXPECT_TRUE(triangleTriangleIntersect(first, inside));
+    EXPECT_TRUE(triangleTriangleIntersect(inside, first));
+    EXPECT_FALSE(triangleTriangleIntersect(first, apart));
+}
+
+TYPED_TEST(TriangleTriangle, Degenerate)
+{
+    typename TestFixture::Triangle3D tr{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}};
+    typename TestFixture::Triangle3D piercing{{0.5, 0.5, -1}, {0.5, 0.5, 1}, {0.5, 0.5, 0}};
+    typename TestFixture::Triangle3D point{{0.5, 0.5, 0}, {0.5, 0.5, 0}, {0.5, 0.5, 0}};
+    typename TestFixture::Triangle3D pointAbove{{0.5, 0.5, 1}, {0.5, 0.5, 1}, {0.5, 0.5, 1}};
+    typename TestFixture::Triangle3D crossingSegment{{-1, 0.5, 0}, {1, 0.5, 0}, {0, 0.5, 0}};
+    typename TestFixture::Triangle3D skewSegment{{0, 0, 1}, {1, 0, 1}, {2, 0, 1}};
+
+    EXPECT_TRUE(triangleTriangleIntersect(tr, piercing));
+    EXPECT_TRUE(triangleTriangleIntersect(point, tr));
+    EXPECT_FALSE(triangleTriangleIntersect(tr, pointAbove));
+    EXPECT_TRUE(triangleTriangleIntersect(point, crossingSegment));
+    EXPECT_TRUE(triangleTriangleIntersect(piercing, crossingSegment));
+    EXPECT_FALSE(triangleTriangleIntersect(skewSegment, crossingSegment));
+}
+
+TYPED_TEST(TriangleTriangle, InvalidVertex)
+{
+    using Point3D = geometry3D::Point3D<TypeParam>;
+
+    typename TestFixture::Triangle3D tr{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}};
+    typename TestFixture::Triangle3D invalid{{0.5, 0.5, -1}, {0.5, 0.5, 1}, Point3D{}};
+    typename TestFixture::Triangle3D nanOnly{Point3D{}, Point3D{}, Point3D{}};
+
+    EXPECT_TRUE(tr.valid());
+    EXPECT_FALSE(invalid.valid());
+
+    geometry3D::TriangleTestStage stage = geometry3D::TriangleTestStage::Coplanar;
+    EXPECT_FALSE(triangleTriangleIntersect(tr, invalid, stage));
+    EXPECT_EQ(stage, geometry3D::TriangleTestStage::Degenerate);
+
+    EXPECT_FALSE(triangleTriangleIntersect(nanOnly, tr));
+    EXPECT_FALSE(triangleTriangleIntersect(nanOnly, nanOnly));
+}
+
+TYPED_TEST(TriangleTriangle, PlaneAndCachedBox)
+{
+    typename TestFixture::Triangle3D tr{{0, 0, 1}, {2, 0, 1}, {0, 3, 1}};
+    typename TestFixture::Triangle3D degenerate{{0, 0, 0}, {1, 1, 1}, {2, 2, 2}};
+
+    EXPECT_FALSE(tr.degenerate());
+    EXPECT_TRUE(degenerate.degenerate());
+
+    EXPECT_EQ(tr.plane().norm, (geometry3D::Vector3D<TypeParam>{0, 0, 1}));
+    EXPECT_NEAR(tr.plane().d, -1, geometry3D::EPS<TypeParam>);
+
+    EXPECT_EQ(tr.box().min, (geometry3D::Point3D<TypeParam>{0, 0, 1}));
+    EXPECT_EQ(tr.box().max, (geometry3D::Point3D<TypeParam>{2, 3, 1}));
+
+    // copies keep the computed box
+    typename TestFixture::Triangle3D copy = tr;
+    EXPECT_EQ(copy.box().min, tr.box().min);
+    EXPECT_EQ(copy.box().max, tr.box().max);
+}
+
+TYPED_TEST(TriangleTriangle, NearlyTouching)
+{
+    typename TestFixture::Triangle3D base{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    typename TestFixture::Triangle3D touching{{0.25, 0.25, 0}, {0.25, 0.25, 1}, {1, 1, 1}};
+    typename TestFixture::Triangle3D above{{0.25, 0.25, TypeParam(1e-9)}, {0.25, 0.25, 1}, {1, 1, 1}};
+
+    EXPECT_TRUE(triangleTriangleIntersect(base, touching));
+    EXPECT_FALSE(triangleTriangleIntersect(base, above));
+}